@@ -0,0 +1,167 @@
+#include "AngleCodec.h"
+
+/**
+  * @brief  写入一个zigzag编码的变长整数
+  * @param  Value 有符号差值
+  * @param  Out 输出位置
+  * @retval 写入的字节数（1~3）
+  * @note   zigzag把小的正负数都映射为小的无符号数，再按每字节7位、最高位表示后续字节存放，
+  *         |差值|<64时只占1字节
+  */
+static uint8_t AngleCodec_PutVarint(int16_t Value, uint8_t *Out)
+{
+	uint16_t Zigzag = (uint16_t)(((uint16_t)Value << 1) ^ (uint16_t)(Value >> 15));
+	uint8_t Length = 0;
+	
+	while (Zigzag >= 0x80)
+	{
+		Out[Length ++] = (uint8_t)(Zigzag | 0x80);
+		Zigzag >>= 7;
+	}
+	Out[Length ++] = (uint8_t)Zigzag;
+	return Length;
+}
+
+/**
+  * @brief  读取一个zigzag编码的变长整数
+  * @param  Data 数据
+  * @param  Length 剩余字节数
+  * @param  Value 读出的差值
+  * @retval 读取的字节数，数据不完整或超过3字节时返回0
+  */
+static uint8_t AngleCodec_GetVarint(const uint8_t *Data, uint8_t Length, int16_t *Value)
+{
+	uint16_t Zigzag = 0;
+	uint8_t i;
+	
+	for (i = 0; i < Length && i < 3; i ++)
+	{
+		Zigzag |= (uint16_t)(Data[i] & 0x7F) << (7 * i);
+		if ((Data[i] & 0x80) == 0)
+		{
+			*Value = (int16_t)((Zigzag >> 1) ^ (uint16_t)-(int16_t)(Zigzag & 1));
+			return i + 1;
+		}
+	}
+	return 0;
+}
+
+/**
+  * @brief  编码器初始化
+  * @param  Encoder 编码器
+  * @retval 无
+  * @note   初始化后第一帧为关键帧
+  */
+void AngleCodec_EncoderInit(AngleEncoder *Encoder)
+{
+	Encoder->KeyId = 0;
+	Encoder->Count = 0;
+	Encoder->Key1 = 0;
+	Encoder->Key2 = 0;
+}
+
+/**
+  * @brief  下一帧强制发送关键帧
+  * @param  Encoder 编码器
+  * @retval 无
+  */
+void AngleCodec_ForceKey(AngleEncoder *Encoder)
+{
+	Encoder->Count = 0;
+}
+
+/**
+  * @brief  编码一组角度
+  * @param  Encoder 编码器
+  * @param  Angle1 角度1（0.1°）
+  * @param  Angle2 角度2（0.1°）
+  * @param  Out 输出缓冲区，至少ANGLE_MAX_LENGTH字节
+  * @retval 输出的字节数；Out[0]带ANGLE_KEY_FLAG时为关键帧
+  * @note   每ANGLE_KEY_INTERVAL帧发送一次关键帧；差分帧不比关键帧短时也改发关键帧
+  */
+uint8_t AngleCodec_Encode(AngleEncoder *Encoder, uint16_t Angle1, uint16_t Angle2, uint8_t *Out)
+{
+	uint8_t Length;
+	
+	if (Encoder->Count > 0)
+	{
+		Out[0] = Encoder->KeyId;
+		Length = 1;
+		Length += AngleCodec_PutVarint((int16_t)(Angle1 - Encoder->Key1), &Out[Length]);
+		Length += AngleCodec_PutVarint((int16_t)(Angle2 - Encoder->Key2), &Out[Length]);
+		if (Length < ANGLE_KEY_LENGTH)
+		{
+			Encoder->Count --;
+			return Length;
+		}
+	}
+	
+	Encoder->KeyId = (Encoder->KeyId + 1) & 0x7F;
+	Encoder->Count = ANGLE_KEY_INTERVAL - 1;
+	Encoder->Key1 = Angle1;
+	Encoder->Key2 = Angle2;
+	Out[0] = ANGLE_KEY_FLAG | Encoder->KeyId;
+	Out[1] = (uint8_t)Angle1;
+	Out[2] = (uint8_t)(Angle1 >> 8);
+	Out[3] = (uint8_t)Angle2;
+	Out[4] = (uint8_t)(Angle2 >> 8);
+	return ANGLE_KEY_LENGTH;
+}
+
+/**
+  * @brief  解码器初始化
+  * @param  Decoder 解码器
+  * @retval 无
+  */
+void AngleCodec_DecoderInit(AngleDecoder *Decoder)
+{
+	Decoder->Valid = 0;
+	Decoder->KeyId = 0;
+	Decoder->Key1 = 0;
+	Decoder->Key2 = 0;
+	Decoder->KeyMiss = 0;
+}
+
+/**
+  * @brief  解码一帧
+  * @param  Decoder 解码器
+  * @param  Data 帧数据
+  * @param  Length 帧长度
+  * @param  Angle1 输出角度1（0.1°）
+  * @param  Angle2 输出角度2（0.1°）
+  * @retval 1表示得到角度，0表示帧格式错误或缺少对应的关键帧
+  * @note   关键帧丢失后，引用它的差分帧全部丢弃，直到下一个关键帧（最长ANGLE_KEY_INTERVAL帧）
+  */
+uint8_t AngleCodec_Decode(AngleDecoder *Decoder, const uint8_t *Data, uint8_t Length, uint16_t *Angle1, uint16_t *Angle2)
+{
+	int16_t Delta1, Delta2;
+	uint8_t Used1, Used2;
+	
+	if (Length == 0) {return 0;}
+	
+	if (Data[0] & ANGLE_KEY_FLAG)
+	{
+		if (Length != ANGLE_KEY_LENGTH) {return 0;}
+		Decoder->Valid = 1;
+		Decoder->KeyId = Data[0] & 0x7F;
+		Decoder->Key1 = Data[1] | (Data[2] << 8);
+		Decoder->Key2 = Data[3] | (Data[4] << 8);
+		*Angle1 = Decoder->Key1;
+		*Angle2 = Decoder->Key2;
+		return 1;
+	}
+	
+	Used1 = AngleCodec_GetVarint(&Data[1], Length - 1, &Delta1);
+	if (Used1 == 0) {return 0;}
+	Used2 = AngleCodec_GetVarint(&Data[1 + Used1], Length - 1 - Used1, &Delta2);
+	if (Used2 == 0 || 1 + Used1 + Used2 != Length) {return 0;}
+	
+	if (!Decoder->Valid || Decoder->KeyId != Data[0])
+	{
+		Decoder->KeyMiss ++;
+		return 0;
+	}
+	*Angle1 = (uint16_t)(Decoder->Key1 + Delta1);
+	*Angle2 = (uint16_t)(Decoder->Key2 + Delta2);
+	return 1;
+}
@@ -0,0 +1,41 @@
+#ifndef __ANGLE_CODEC_H
+#define __ANGLE_CODEC_H
+
+#include <stdint.h>
+
+#define ANGLE_KEY_FLAG		0x80		//首字节最高位为1表示关键帧，低7位为关键帧编号
+#define ANGLE_KEY_INTERVAL	25			//关键帧间隔（帧），8ms主循环下约200ms，决定丢失关键帧后的最长恢复时间
+#define ANGLE_KEY_LENGTH	5			//关键帧长度：编号 + 两个16位绝对角度
+#define ANGLE_MAX_LENGTH	7			//差分帧最大长度：编号 + 两个最长3字节的变长整数
+
+/**
+ * @brief 双角度编码器（发送端）
+ * @note 关键帧：[0x80|编号][角度1低8位][角度1高8位][角度2低8位][角度2高8位]
+ *       差分帧：[编号][zigzag变长整数(角度1-关键帧角度1)][zigzag变长整数(角度2-关键帧角度2)]
+ *       差分相对于最近的关键帧而非上一帧，差分帧丢失不影响后续帧的解码
+ */
+typedef struct {
+	uint8_t KeyId;						//当前关键帧编号（0~127）
+	uint8_t Count;						//距下一个关键帧的剩余帧数，为0时发送关键帧
+	uint16_t Key1;						//当前关键帧角度1
+	uint16_t Key2;						//当前关键帧角度2
+} AngleEncoder;
+
+/**
+ * @brief 双角度解码器（接收端）
+ */
+typedef struct {
+	uint8_t Valid;						//已收到关键帧
+	uint8_t KeyId;						//已收到的关键帧编号
+	uint16_t Key1;						//关键帧角度1
+	uint16_t Key2;						//关键帧角度2
+	uint32_t KeyMiss;					//因缺少对应关键帧而丢弃的差分帧数
+} AngleDecoder;
+
+void AngleCodec_EncoderInit(AngleEncoder *Encoder);
+uint8_t AngleCodec_Encode(AngleEncoder *Encoder, uint16_t Angle1, uint16_t Angle2, uint8_t *Out);
+void AngleCodec_ForceKey(AngleEncoder *Encoder);
+void AngleCodec_DecoderInit(AngleDecoder *Decoder);
+uint8_t AngleCodec_Decode(AngleDecoder *Decoder, const uint8_t *Data, uint8_t Length, uint16_t *Angle1, uint16_t *Angle2);
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef __CRC_H
+#define __CRC_H
+
+#include <stdint.h>
+
+uint16_t Crc16(const uint8_t *Data, uint8_t Length);
+
+#endif
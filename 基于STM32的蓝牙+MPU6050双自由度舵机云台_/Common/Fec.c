@@ -0,0 +1,201 @@
+#include <string.h>
+#include "Fec.h"
+#include "Crc.h"
+
+/**
+  * @brief  编码器初始化
+  * @param  Encoder 编码器
+  * @param  Group 每组数据包数，0~FEC_MAX_GROUP，0表示关闭
+  * @retval 无
+  * @note   修改组大小时重新调用，未满的组被放弃
+  */
+void Fec_EncoderInit(FecEncoder *Encoder, uint8_t Group)
+{
+	Encoder->Group = (Group > FEC_MAX_GROUP) ? FEC_MAX_GROUP : Group;
+	Encoder->Count = 0;
+	Encoder->Pending = 0;
+}
+
+/**
+  * @brief  把已确定的数据包计入当前组
+  * @param  Encoder 编码器
+  * @retval 无
+  */
+static void Fec_Fold(FecEncoder *Encoder)
+{
+	uint8_t i;
+	
+	if (Encoder->Count == 0)
+	{
+		Encoder->First = Encoder->PendSeq;
+		Encoder->LenXor = 0;
+		Encoder->MaxLen = 0;
+		memset(Encoder->Xor, 0, LINK_MAX_DATA);
+	}
+	for (i = 0; i < Encoder->PendLen; i ++)
+	{
+		Encoder->Xor[i] ^= Encoder->Pend[i];
+	}
+	Encoder->LenXor ^= Encoder->PendLen;
+	if (Encoder->PendLen > Encoder->MaxLen) {Encoder->MaxLen = Encoder->PendLen;}
+	Encoder->Count ++;
+}
+
+/**
+  * @brief  为当前组生成校验帧并开始新的一组
+  * @param  Encoder 编码器
+  * @param  Out 校验帧输出缓冲区，至少LINK_MAX_ENCODED字节
+  * @retval 校验帧编码后的长度
+  */
+static uint8_t Fec_Parity(FecEncoder *Encoder, uint8_t *Out)
+{
+	uint8_t Frame[LINK_MAX_FRAME];
+	uint16_t Crc;
+	
+	Frame[0] = Encoder->First;
+	Frame[1] = (uint8_t)((Encoder->Count << 5) | Encoder->LenXor);
+	memcpy(&Frame[2], Encoder->Xor, Encoder->MaxLen);
+	Crc = Crc16(Frame, Encoder->MaxLen + 2) ^ LINK_PARITY_MASK;
+	Frame[Encoder->MaxLen + 2] = (uint8_t)Crc;
+	Frame[Encoder->MaxLen + 3] = (uint8_t)(Crc >> 8);
+	Encoder->Count = 0;
+	Encoder->Sent ++;
+	return Link_Encode(Frame, Encoder->MaxLen + LINK_PARITY_OVERHEAD, Out);
+}
+
+/**
+  * @brief  登记一个将要发出的数据包，需要时生成校验帧
+  * @param  Encoder 编码器
+  * @param  Seq 数据包序号
+  * @param  Data 数据（不含序号和CRC）
+  * @param  Length 数据长度，1~LINK_MAX_DATA
+  * @param  Out 校验帧输出缓冲区，至少LINK_MAX_ENCODED字节
+  * @retval 校验帧编码后的长度，应在本数据包之前发出；0表示无需发送
+  * @note   序号与上一次相同表示替换尚未发出的旧包，以新内容为准；出现新序号时上一个包才确定，
+  *         此时计入当前组，组满则生成校验帧
+  */
+uint8_t Fec_Encode(FecEncoder *Encoder, uint8_t Seq, const uint8_t *Data, uint8_t Length, uint8_t *Out)
+{
+	uint8_t Size = 0;
+	
+	if (Encoder->Group == 0) {return 0;}
+	if (Length > LINK_MAX_DATA) {Length = LINK_MAX_DATA;}
+	
+	if (Encoder->Pending && Seq != Encoder->PendSeq)
+	{
+		Fec_Fold(Encoder);
+		if (Encoder->Count >= Encoder->Group)
+		{
+			Size = Fec_Parity(Encoder, Out);
+		}
+	}
+	Encoder->Pending = 1;
+	Encoder->PendSeq = Seq;
+	Encoder->PendLen = Length;
+	memcpy(Encoder->Pend, Data, Length);
+	return Size;
+}
+
+/**
+  * @brief  结束当前组：确定尚未计入的数据包并立即生成校验帧
+  * @param  Encoder 编码器
+  * @param  Out 校验帧输出缓冲区，至少LINK_MAX_ENCODED字节
+  * @retval 校验帧编码后的长度，应在已登记的数据包之后发出；0表示当前组为空
+  * @note   用于发送暂停（如静止时省略角度帧）：否则组内最后一个包要等下一个新序号的包出现才确定，
+  *         其校验帧随之推迟，恰恰是运动停止前的最后一帧丢失后迟迟得不到还原；
+  *         调用后尚未计入的数据包已确定，不可再被替换；未满的组按实际个数生成校验帧
+  */
+uint8_t Fec_Flush(FecEncoder *Encoder, uint8_t *Out)
+{
+	if (Encoder->Group == 0) {return 0;}
+	if (Encoder->Pending)
+	{
+		Fec_Fold(Encoder);
+		Encoder->Pending = 0;
+	}
+	if (Encoder->Count == 0) {return 0;}
+	return Fec_Parity(Encoder, Out);
+}
+
+/**
+  * @brief  解码器初始化
+  * @param  Decoder 解码器
+  * @retval 无
+  */
+void Fec_DecoderInit(FecDecoder *Decoder)
+{
+	memset(Decoder, 0, sizeof(FecDecoder));
+}
+
+/**
+  * @brief  保存一个通过校验的数据包，供还原同组丢失的数据包
+  * @param  Decoder 解码器
+  * @param  Seq 序号
+  * @param  Data 数据（不含序号和CRC）
+  * @param  Length 数据长度
+  * @retval 无
+  */
+void Fec_Store(FecDecoder *Decoder, uint8_t Seq, const uint8_t *Data, uint8_t Length)
+{
+	uint8_t Slot = Seq % FEC_HISTORY;
+	
+	if (Length > LINK_MAX_DATA) {Length = LINK_MAX_DATA;}
+	Decoder->Seq[Slot] = Seq;
+	Decoder->Len[Slot] = Length;
+	memcpy(Decoder->Data[Slot], Data, Length);
+}
+
+/**
+  * @brief  用校验帧还原同组中丢失的数据包
+  * @param  Decoder 解码器
+  * @param  Frame 校验帧（已由Link_IsParity确认）
+  * @param  Length 校验帧长度
+  * @param  Out 还原的数据输出缓冲区，至少LINK_MAX_DATA字节
+  * @retval 还原的数据长度；本组没有丢失或丢失多于一个时返回0
+  * @note   还原的数据包晚于同组后面的数据包到达，序号已计入Lost，不再经过Link_Check
+  */
+uint8_t Fec_Repair(FecDecoder *Decoder, const uint8_t *Frame, uint8_t Length, uint8_t *Out)
+{
+	uint8_t First = Frame[0];
+	uint8_t Count = Frame[1] >> 5;
+	uint8_t Size = Frame[1] & 0x1F;
+	uint8_t XorLen = Length - LINK_PARITY_OVERHEAD;
+	uint8_t Missing = 0xFF;
+	uint8_t Seq, Slot, i, j;
+	
+	Decoder->Parity ++;
+	if (Count == 0 || Count > FEC_MAX_GROUP || XorLen > LINK_MAX_DATA) {return 0;}
+	
+	for (i = 0; i < Count; i ++)
+	{
+		Seq = (uint8_t)(First + i);
+		Slot = Seq % FEC_HISTORY;
+		if (Decoder->Len[Slot] > 0 && Decoder->Seq[Slot] == Seq) {continue;}
+		if (Missing != 0xFF)
+		{
+			Decoder->Unrecoverable ++;
+			return 0;
+		}
+		Missing = i;
+	}
+	if (Missing == 0xFF) {return 0;}
+	
+	memcpy(Out, &Frame[2], XorLen);
+	memset(&Out[XorLen], 0, LINK_MAX_DATA - XorLen);
+	for (i = 0; i < Count; i ++)
+	{
+		if (i == Missing) {continue;}
+		Slot = (uint8_t)(First + i) % FEC_HISTORY;
+		Size ^= Decoder->Len[Slot];
+		for (j = 0; j < Decoder->Len[Slot]; j ++)
+		{
+			Out[j] ^= Decoder->Data[Slot][j];
+		}
+	}
+	if (Size == 0 || Size > XorLen) {return 0;}
+	
+	Seq = (uint8_t)(First + Missing);
+	Fec_Store(Decoder, Seq, Out, Size);
+	Decoder->Recovered ++;
+	return Size;
+}
@@ -0,0 +1,51 @@
+#ifndef __FEC_H
+#define __FEC_H
+
+#include <stdint.h>
+#include "Link.h"
+
+#define FEC_MAX_GROUP		7			//每组最多数据包数（个数占校验帧第2字节的高3位）
+#define FEC_HISTORY			8			//接收端保存的最近数据包数，不小于FEC_MAX_GROUP + 1
+
+/**
+ * @brief 异或校验前向纠错
+ * @note 发送端每N个连续序号的数据包之后插入一个校验帧：
+ *       [首序号][个数 << 5 | 各包数据长度的异或][各包数据按字节异或（按最长的包补0）][CRC-16 ^ LINK_PARITY_MASK]
+ *       校验帧不占用序号。一组中恰好丢失一个数据包（整帧丢失或CRC错误）时，接收端用校验帧与其余
+ *       数据包异或即可还原，不需要重传；增加的时延为从该包到本组校验帧的时间，带宽开销约1/N；
+ *       发送暂停时用Fec_Flush提前结束未满的组，校验帧中的个数为实际包数
+ */
+typedef struct {
+	uint8_t Group;						//每组数据包数，0表示关闭
+	uint8_t Count;						//当前组已计入的数据包数
+	uint8_t First;						//当前组第一个数据包的序号
+	uint8_t LenXor;						//当前组数据长度的异或
+	uint8_t MaxLen;						//当前组最长的数据长度
+	uint8_t Xor[LINK_MAX_DATA];			//当前组数据的异或
+	uint8_t Pending;					//有尚未计入的数据包（仍可能被替换）
+	uint8_t PendSeq;					//该包的序号
+	uint8_t PendLen;					//该包的数据长度
+	uint8_t Pend[LINK_MAX_DATA];		//该包的数据
+	uint32_t Sent;						//发出的校验帧数
+} FecEncoder;
+
+/**
+ * @brief 异或校验解码器（接收端）
+ */
+typedef struct {
+	uint8_t Seq[FEC_HISTORY];			//各槽保存的数据包序号，槽号 = 序号 % FEC_HISTORY
+	uint8_t Len[FEC_HISTORY];			//各槽的数据长度，0表示空
+	uint8_t Data[FEC_HISTORY][LINK_MAX_DATA];
+	uint32_t Parity;					//收到的校验帧数
+	uint32_t Recovered;					//还原的数据包数
+	uint32_t Unrecoverable;				//一组中丢失多于一个、无法还原的次数
+} FecDecoder;
+
+void Fec_EncoderInit(FecEncoder *Encoder, uint8_t Group);
+uint8_t Fec_Encode(FecEncoder *Encoder, uint8_t Seq, const uint8_t *Data, uint8_t Length, uint8_t *Out);
+uint8_t Fec_Flush(FecEncoder *Encoder, uint8_t *Out);
+void Fec_DecoderInit(FecDecoder *Decoder);
+void Fec_Store(FecDecoder *Decoder, uint8_t Seq, const uint8_t *Data, uint8_t Length);
+uint8_t Fec_Repair(FecDecoder *Decoder, const uint8_t *Frame, uint8_t Length, uint8_t *Out);
+
+#endif
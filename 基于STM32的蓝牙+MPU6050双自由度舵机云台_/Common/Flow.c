@@ -0,0 +1,106 @@
+#include "Flow.h"
+
+/**
+  * @brief  信用流控初始化
+  * @param  F 信用流控
+  * @retval 无
+  */
+void Flow_Init(Flow *F)
+{
+	uint8_t i;
+	
+	for (i = 0; i < FLOW_NODES; i ++)
+	{
+		F->Credit[i].Valid = 0;
+	}
+	F->InFlight = 0;
+	F->Blocked = 0;
+}
+
+/**
+  * @brief  收到接收端的信用（发送端调用）
+  * @param  F 信用流控
+  * @param  Node 接收端地址
+  * @param  Credit CREDIT消息体
+  * @param  Now 接收时间（us）
+  * @retval 无
+  * @note   新的接收端占用空闲或已超时的表项，表满时忽略
+  */
+void Flow_OnCredit(Flow *F, uint8_t Node, const MsgCredit *Credit, uint32_t Now)
+{
+	FlowCredit *Slot = 0;
+	uint8_t i;
+	
+	for (i = 0; i < FLOW_NODES; i ++)
+	{
+		if (F->Credit[i].Valid && F->Credit[i].Node == Node)
+		{
+			Slot = &F->Credit[i];
+			break;
+		}
+		if (Slot == 0 && (!F->Credit[i].Valid || Now - F->Credit[i].Time >= FLOW_TIMEOUT))
+		{
+			Slot = &F->Credit[i];
+		}
+	}
+	if (Slot == 0) {return;}
+	
+	Slot->Valid = 1;
+	Slot->Node = Node;
+	Slot->Acked = Credit->Acked;
+	Slot->Window = Credit->Window;
+	Slot->Time = Now;
+}
+
+/**
+  * @brief  判断是否可以发出新的数据包（发送端调用）
+  * @param  F 信用流控
+  * @param  NextSeq 下一个数据包的链路序号
+  * @param  Now 当前时间（us）
+  * @retval 1表示可以发送，0表示有接收端的窗口已满
+  * @note   多个接收端时按最慢的一个限流；没有有效信用（旧版本接收端或链路中断）时不限流
+  */
+uint8_t Flow_Ready(Flow *F, uint8_t NextSeq, uint32_t Now)
+{
+	uint8_t Ready = 1;
+	uint8_t InFlight, i;
+	
+	F->InFlight = 0;
+	for (i = 0; i < FLOW_NODES; i ++)
+	{
+		if (!F->Credit[i].Valid || Now - F->Credit[i].Time >= FLOW_TIMEOUT) {continue;}
+		
+		InFlight = (uint8_t)(NextSeq - F->Credit[i].Acked - 1);
+		if (InFlight > F->InFlight) {F->InFlight = InFlight;}
+		if (InFlight >= F->Credit[i].Window) {Ready = 0;}
+	}
+	if (!Ready) {F->Blocked ++;}
+	return Ready;
+}
+
+/**
+  * @brief  需要时生成信用消息（接收端调用）
+  * @param  Adv 信用通告状态
+  * @param  Stats 链路接收统计，取最近接受的序号
+  * @param  Window 本端允许在途的数据包数，0表示不参与流控（不发送信用）
+  * @param  Now 当前时间（us）
+  * @param  Credit 输出的CREDIT消息体
+  * @retval 1表示需要发送，0表示本次无需发送
+  * @note   在主循环处理完接收队列后调用，此时确认的序号即已处理的序号；
+  *         有新数据包时最快每FLOW_CREDIT_INTERVAL通告一次，否则每FLOW_CREDIT_REFRESH重发一次
+  */
+uint8_t Flow_MakeCredit(FlowAdvert *Adv, const LinkStats *Stats, uint8_t Window, uint32_t Now, MsgCredit *Credit)
+{
+	uint32_t Interval;
+	
+	if (Window == 0 || !Stats->Synced) {return 0;}
+	
+	Interval = (Stats->LastSeq != Adv->Acked) ? FLOW_CREDIT_INTERVAL : FLOW_CREDIT_REFRESH;
+	if (Now - Adv->Time < Interval) {return 0;}
+	
+	Adv->Acked = Stats->LastSeq;
+	Adv->Time = Now;
+	Credit->Acked = Stats->LastSeq;
+	Credit->Window = Window;
+	return 1;
+}
@@ -0,0 +1,49 @@
+#ifndef __FLOW_H
+#define __FLOW_H
+
+#include <stdint.h>
+#include "Message.h"
+#include "Link.h"
+
+#define FLOW_NODES				4			//发送端最多同时跟踪的接收端数
+#define FLOW_TIMEOUT			500000		//信用超时（us），超时的接收端不再限流（已离线或不支持流控）
+#define FLOW_CREDIT_INTERVAL	16000		//接收端有新数据包时发送信用的最小间隔（us）
+#define FLOW_CREDIT_REFRESH		100000		//没有新数据包时重发信用的间隔（us），信用丢失后由此恢复
+
+/**
+ * @brief 一个接收端的信用
+ */
+typedef struct {
+	uint8_t Valid;						//已收到过该接收端的信用
+	uint8_t Node;						//接收端地址
+	uint8_t Acked;						//接收端已处理的最新链路序号
+	uint8_t Window;						//接收端允许在途的数据包数
+	uint32_t Time;						//收到信用的时间（us）
+} FlowCredit;
+
+/**
+ * @brief 信用流控（发送端）
+ * @note 接收端定期通告已处理到的链路序号和窗口，发送端的在途包数 = 已发出的最新序号 - 确认序号；
+ *       在途包数达到窗口时不再发出新的角度，数据不会在蓝牙模块缓冲区中堆积，
+ *       恢复后发出的是当时最新的姿态而不是排队的旧姿态；按链路序号确认，丢包不会使在途包数累积
+ */
+typedef struct {
+	FlowCredit Credit[FLOW_NODES];
+	uint8_t InFlight;					//最近一次检查时最慢接收端的在途包数
+	uint32_t Blocked;					//因窗口已满而推迟的次数
+} Flow;
+
+/**
+ * @brief 信用通告（接收端）
+ */
+typedef struct {
+	uint8_t Acked;						//上次通告的序号
+	uint32_t Time;						//上次通告的时间（us）
+} FlowAdvert;
+
+void Flow_Init(Flow *F);
+void Flow_OnCredit(Flow *F, uint8_t Node, const MsgCredit *Credit, uint32_t Now);
+uint8_t Flow_Ready(Flow *F, uint8_t NextSeq, uint32_t Now);
+uint8_t Flow_MakeCredit(FlowAdvert *Adv, const LinkStats *Stats, uint8_t Window, uint32_t Now, MsgCredit *Credit);
+
+#endif
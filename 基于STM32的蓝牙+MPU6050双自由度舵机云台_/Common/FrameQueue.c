@@ -0,0 +1,136 @@
+#include <string.h>
+#include <stddef.h>
+#include "FrameQueue.h"
+#include "Proto.h"
+
+/**
+  * @brief  编译期检查：队列槽内第一个消息体4字节对齐，Proto_Dispatch不必复制到临时缓冲区
+  */
+typedef char FrameQueue_AssertBodyAligned[((offsetof(QueueFrame, Data) + PROTO_HEADER) % 4 == 0) ? 1 : -1];
+
+/**
+  * @brief  队列初始化
+  * @param  Queue 队列
+  * @retval 无
+  * @note   需在生产者开始写入前调用
+  */
+void FrameQueue_Init(FrameQueue *Queue)
+{
+	Queue->Head = 0;
+	Queue->Tail = 0;
+	Queue->Overflow = 0;
+	Queue->Stale = 0;
+}
+
+/**
+  * @brief  获取队列中的帧数
+  * @param  Queue 队列
+  * @retval 帧数
+  */
+uint8_t FrameQueue_Count(const FrameQueue *Queue)
+{
+	return (uint8_t)(Queue->Head - Queue->Tail);
+}
+
+/**
+  * @brief  生产者：取得下一个空槽，直接在槽内组帧
+  * @param  Queue 队列
+  * @retval 空槽指针，队列满时返回0并计一次溢出
+  * @note   写完后调用FrameQueue_Commit发布；不调用Commit则该槽下次仍会被返回，相当于放弃本帧
+  */
+QueueFrame *FrameQueue_Reserve(FrameQueue *Queue)
+{
+	uint8_t Head = Queue->Head;
+	if ((uint8_t)(Head - Queue->Tail) >= FRAME_QUEUE_SIZE)
+	{
+		Queue->Overflow++;
+		return 0;
+	}
+	return &Queue->Slot[Head & (FRAME_QUEUE_SIZE - 1)];
+}
+
+/**
+  * @brief  生产者：发布FrameQueue_Reserve取得的槽
+  * @param  Queue 队列
+  * @retval 无
+  */
+void FrameQueue_Commit(FrameQueue *Queue)
+{
+	FRAME_QUEUE_DMB();					//帧内容写完后才更新Head
+	Queue->Head = Queue->Head + 1;
+}
+
+/**
+  * @brief  生产者：复制一帧入队
+  * @param  Queue 队列
+  * @param  Data 帧内容
+  * @param  Length 帧长度，超过FRAME_QUEUE_DATA的部分被截断
+  * @param  Time 接收时间（us）
+  * @retval 1表示入队成功，0表示队列满
+  */
+uint8_t FrameQueue_Push(FrameQueue *Queue, const uint8_t *Data, uint8_t Length, uint32_t Time)
+{
+	QueueFrame *Frame = FrameQueue_Reserve(Queue);
+	if (Frame == 0) {return 0;}
+	if (Length > FRAME_QUEUE_DATA) {Length = FRAME_QUEUE_DATA;}
+	memcpy(Frame->Data, Data, Length);
+	Frame->Length = Length;
+	Frame->Time = Time;
+	FrameQueue_Commit(Queue);
+	return 1;
+}
+
+/**
+  * @brief  消费者：查看最早的一帧（按顺序消费）
+  * @param  Queue 队列
+  * @retval 帧指针，队列空时返回0
+  * @note   帧内容在FrameQueue_Pop之前不会被生产者改写，可直接原地解析
+  */
+const QueueFrame *FrameQueue_Peek(FrameQueue *Queue)
+{
+	uint8_t Tail = Queue->Tail;
+	if (Queue->Head == Tail) {return 0;}
+	FRAME_QUEUE_DMB();					//看到新的Head之后再读帧内容
+	return &Queue->Slot[Tail & (FRAME_QUEUE_SIZE - 1)];
+}
+
+/**
+  * @brief  消费者：丢弃已被后一帧取代的旧帧，查看剩下的最早一帧
+  * @param  Queue 队列
+  * @param  Replaceable 判断一帧是否自成一体、只关心最新值（如完整的角度或姿态）
+  * @retval 帧指针，队列空时返回0
+  * @note   最早的一帧和紧随其后的一帧都满足Replaceable时丢弃最早的一帧，计入Stale，
+  *         重复直到不满足；其余帧（差分帧、应答等）不会被跳过，仍按顺序交付
+  */
+const QueueFrame *FrameQueue_PeekNewest(FrameQueue *Queue, FrameQueue_Filter Replaceable)
+{
+	uint8_t Head = Queue->Head;
+	uint8_t Tail = Queue->Tail;
+	if (Head == Tail) {return 0;}
+	FRAME_QUEUE_DMB();					//看到新的Head之后再读帧内容
+	while ((uint8_t)(Head - Tail) > 1
+	       && Replaceable(&Queue->Slot[Tail & (FRAME_QUEUE_SIZE - 1)])
+	       && Replaceable(&Queue->Slot[(uint8_t)(Tail + 1) & (FRAME_QUEUE_SIZE - 1)]))
+	{
+		Tail ++;
+		Queue->Stale ++;
+	}
+	if (Tail != Queue->Tail)
+	{
+		FRAME_QUEUE_DMB();				//旧帧读完后才释放槽
+		Queue->Tail = Tail;
+	}
+	return &Queue->Slot[Tail & (FRAME_QUEUE_SIZE - 1)];
+}
+
+/**
+  * @brief  消费者：释放当前帧
+  * @param  Queue 队列
+  * @retval 无
+  */
+void FrameQueue_Pop(FrameQueue *Queue)
+{
+	if (Queue->Head == Queue->Tail) {return;}
+	FRAME_QUEUE_DMB();					//帧内容读完后才释放槽
+	Queue->Tail = Queue->Tail + 1;
+}
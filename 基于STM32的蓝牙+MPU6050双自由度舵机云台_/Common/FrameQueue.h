@@ -0,0 +1,61 @@
+#ifndef __FRAME_QUEUE_H
+#define __FRAME_QUEUE_H
+
+#include <stdint.h>
+
+#define FRAME_QUEUE_SIZE	8			//队列槽数，必须为2的幂且不超过128
+#define FRAME_QUEUE_DATA	32			//每帧最大字节数
+
+/**
+ * @brief 内存屏障：生产者先写完帧内容再发布Head，消费者先读完帧内容再释放Tail
+ */
+#if defined(__CC_ARM)
+#define FRAME_QUEUE_DMB()	__dmb(0xF)
+#elif defined(__GNUC__)
+#define FRAME_QUEUE_DMB()	__sync_synchronize()
+#else
+#define FRAME_QUEUE_DMB()
+#endif
+
+/**
+ * @brief 队列中的一帧
+ */
+typedef struct {
+	uint32_t Time;						//接收时间（us），由生产者填写
+	uint8_t Length;						//有效字节数
+	uint8_t Reserved[2];				//保留，使第一个消息体4字节对齐
+	uint8_t Data[FRAME_QUEUE_DATA];		//帧内容，从结构体偏移7开始，其后5字节（协议头与第一个TLV头，
+										//见PROTO_HEADER）之后的第一个消息体从偏移12开始，4字节对齐，可就地解析
+} QueueFrame;
+
+/**
+ * @brief 判断一帧能否被紧随其后的同类帧取代（FrameQueue_PeekNewest）
+ */
+typedef uint8_t (*FrameQueue_Filter)(const QueueFrame *Frame);
+
+/**
+ * @brief 单生产者/单消费者无锁帧队列
+ * @note Head只由生产者修改，Tail只由消费者（主循环）修改，
+ *       二者均为自由递增的8位计数，相减即为队列中的帧数，无需关中断；
+ *       发送端的生产者是USART1中断，队列在中断与主循环之间交接帧；接收端的生产者是主循环中的
+ *       Serial_ProcessRx（字节由DMA写入环形缓冲区），生产与消费在主循环中先后进行、没有并发，
+ *       队列暂存一次解析出的多个帧，由消费者按顺序处理或跳过已被取代的旧帧
+ */
+typedef struct {
+	volatile uint8_t Head;				//下一个写入位置（生产者）
+	volatile uint8_t Tail;				//下一个读取位置（消费者）
+	uint32_t Overflow;					//队列满而丢弃的新帧数（生产者计数）
+	uint32_t Stale;						//被后一帧取代而跳过的旧帧数（消费者计数）
+	QueueFrame Slot[FRAME_QUEUE_SIZE];
+} FrameQueue;
+
+void FrameQueue_Init(FrameQueue *Queue);
+QueueFrame *FrameQueue_Reserve(FrameQueue *Queue);
+void FrameQueue_Commit(FrameQueue *Queue);
+uint8_t FrameQueue_Push(FrameQueue *Queue, const uint8_t *Data, uint8_t Length, uint32_t Time);
+const QueueFrame *FrameQueue_Peek(FrameQueue *Queue);
+const QueueFrame *FrameQueue_PeekNewest(FrameQueue *Queue, FrameQueue_Filter Replaceable);
+void FrameQueue_Pop(FrameQueue *Queue);
+uint8_t FrameQueue_Count(const FrameQueue *Queue);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef __GIMBAL_H
+#define __GIMBAL_H
+
+/**
+ * @brief 云台机械参数（两端共用的默认值）
+ * @note 角度模式下发送端按这些值把倾角换算为舵机角度，接收端按同样的值限位和换算四元数，
+ *       两端必须一致，因此只在这里定义一次；运行中可分别通过参数命令修改
+ */
+#define ANGLE_RANGE			30.0f		//有效倾角范围（±度），倾角±ANGLE_RANGE线性对应舵机的[MIN, MAX]
+#define SERVO1_MIN			30.0f		//舵机1最小角度（度）
+#define SERVO1_MAX			150.0f		//舵机1最大角度（度）
+#define SERVO2_MIN			0.0f		//舵机2最小角度（度）
+#define SERVO2_MAX			180.0f		//舵机2最大角度（度）
+
+/**
+ * @brief 主循环间隔（ms）
+ * @note 发送端每圈采样并发送一次，接收端每圈处理一次，两端相同
+ */
+#define LOOP_INTERVAL		8
+
+#endif
@@ -0,0 +1,221 @@
+#include "stm32f10x.h"                  // Device header
+#include <string.h>
+#include "Delay.h"
+#include "Timer.h"
+#include "Serial.h"
+#include "Watchdog.h"
+#include "HC05.h"
+
+/**
+ * @brief HC-05 KEY引脚（模块34脚）：高电平时模块以当前波特率接受AT指令
+ */
+#define HC05_KEY_PORT		GPIOA
+#define HC05_KEY_PIN		GPIO_Pin_8
+
+#define HC05_REPLY_SIZE		32			//应答缓冲区大小
+#define HC05_CMD_TIMEOUT	200			//单条指令应答超时（ms）
+#define HC05_RESET_DELAY	800			//AT+RESET后模块重启等待时间（ms）
+#define HC05_BKP_DR			BKP_DR10	//保存协商结果（波特率/100），热启动时直接沿用
+
+/**
+ * @brief 探测模块当前波特率时依次尝试的速率，目标速率在运行时放在最前面
+ */
+static const uint32_t HC05_ProbeBaud[] = {9600, 38400, 115200, 57600, 19200, 230400, 460800};
+
+/**
+ * @brief 拼接"前缀 + 十进制数 + 后缀"
+ * @param Out 输出缓冲区
+ * @param Prefix 前缀
+ * @param Number 数值
+ * @param Suffix 后缀
+ * @retval 无
+ * @note 代替sprintf，避免为几条AT指令链接整套格式化库
+ */
+static void HC05_Format(char *Out, const char *Prefix, uint32_t Number, const char *Suffix){
+	char Digit[10];
+	uint8_t n = 0;
+	
+	do{
+		Digit[n++] = '0' + Number % 10;
+		Number /= 10;
+	}while(Number > 0);
+	
+	strcpy(Out, Prefix);
+	Out += strlen(Out);
+	while(n > 0){
+		*Out++ = Digit[--n];
+	}
+	strcpy(Out, Suffix);
+}
+
+/**
+ * @brief 设置KEY引脚电平
+ * @param BitValue 1进入AT指令模式，0回到透传模式
+ * @retval 无
+ */
+static void HC05_SetKey(uint8_t BitValue){
+	GPIO_WriteBit(HC05_KEY_PORT, HC05_KEY_PIN, (BitAction)BitValue);
+}
+
+/**
+ * @brief 发送一条AT指令并等待应答
+ * @param Cmd 指令字符串（含\r\n）
+ * @param Expect 期望在应答中出现的字符串
+ * @retval 1表示收到期望的应答，0表示超时
+ * @note 期间暂停串口接收，直接查询RXNE，避免应答被角度帧接收流程吞掉
+ */
+static uint8_t HC05_Command(char *Cmd, const char *Expect){
+	char Reply[HC05_REPLY_SIZE];
+	uint8_t Len = 0;
+	uint8_t Found = 0;
+	uint32_t Start;
+	
+	Serial_RxSuspend();
+	while(USART_GetFlagStatus(USART1, USART_FLAG_RXNE) == SET){
+		USART_ReceiveData(USART1);  // 丢弃残留数据
+	}
+	
+	Serial_SendString(Cmd);
+	Serial_Flush();
+	
+	Start = Timer_GetMicros();
+	while(Timer_GetMicros() - Start < HC05_CMD_TIMEOUT * 1000UL){
+		if(USART_GetFlagStatus(USART1, USART_FLAG_RXNE) == SET){
+			char c = (char)USART_ReceiveData(USART1);
+			if(Len >= HC05_REPLY_SIZE - 1){  // 缓冲区满：保留后半段继续匹配
+				memmove(Reply, Reply + HC05_REPLY_SIZE / 2, Len - HC05_REPLY_SIZE / 2);
+				Len -= HC05_REPLY_SIZE / 2;
+			}
+			Reply[Len++] = c;
+			Reply[Len] = '\0';
+			if(strstr(Reply, Expect) != 0){
+				Found = 1;
+				break;
+			}
+		}
+	}
+	
+	Serial_RxResume();
+	return Found;
+}
+
+/**
+ * @brief 以指定波特率探测模块是否应答
+ * @param BaudRate 波特率
+ * @retval 1表示模块以该速率应答AT
+ */
+static uint8_t HC05_Probe(uint32_t BaudRate){
+	Serial_SetBaudRate(BaudRate);
+	return HC05_Command("AT\r\n", "OK");
+}
+
+/**
+ * @brief HC-05 KEY引脚初始化
+ * @param 无
+ * @retval 无
+ */
+void HC05_Init(void){
+	RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);
+	
+	GPIO_InitTypeDef GPIO_InitStructure;
+	GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_PP;  // 推挽输出
+	GPIO_InitStructure.GPIO_Pin = HC05_KEY_PIN;
+	GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+	GPIO_Init(HC05_KEY_PORT, &GPIO_InitStructure);
+	
+	HC05_SetKey(0);  // 默认透传模式
+}
+
+/**
+ * @brief 与HC-05协商串口波特率（实际协商过程）
+ * @param TargetBaud 目标波特率
+ * @retval 协商后USART1实际使用的波特率
+ * @note 流程：拉高KEY进入AT模式 -> 依次探测模块当前波特率 -> AT+UART设置目标速率 ->
+ *       AT+UART?读回确认 -> AT+RESET使其生效 -> USART1切换到目标速率并再次以AT验证。
+ *       任一步失败都回退到模块仍能应答的速率；一次都探测不到时回到HC05_DEFAULT_BAUD
+ */
+static uint32_t HC05_DoNegotiate(uint32_t TargetBaud){
+	char Cmd[32];
+	uint32_t Current = 0;
+	uint8_t i;
+	
+	HC05_SetKey(1);
+	Delay_ms(50);
+	
+	// 1. 探测模块当前波特率，目标速率优先
+	if(HC05_Probe(TargetBaud)){
+		Current = TargetBaud;
+	}
+	for(i = 0; Current == 0 && i < sizeof(HC05_ProbeBaud) / sizeof(HC05_ProbeBaud[0]); i++){
+		if(HC05_ProbeBaud[i] != TargetBaud && HC05_Probe(HC05_ProbeBaud[i])){
+			Current = HC05_ProbeBaud[i];
+		}
+	}
+	if(Current == 0){  // 模块无应答（未接KEY引脚或已连接），保持默认速率
+		HC05_SetKey(0);
+		Serial_SetBaudRate(HC05_DEFAULT_BAUD);
+		return HC05_DEFAULT_BAUD;
+	}
+	if(Current == TargetBaud){  // 已是目标速率
+		HC05_SetKey(0);
+		return TargetBaud;
+	}
+	
+	// 2. 设置并读回确认
+	HC05_Format(Cmd, "AT+UART=", TargetBaud, ",0,0\r\n");
+	if(!HC05_Command(Cmd, "OK")){
+		HC05_SetKey(0);
+		return Current;
+	}
+	HC05_Format(Cmd, "+UART:", TargetBaud, "");
+	if(!HC05_Command("AT+UART?\r\n", Cmd)){
+		HC05_Format(Cmd, "AT+UART=", Current, ",0,0\r\n");  // 读回不一致，恢复原设置
+		HC05_Command(Cmd, "OK");
+		HC05_SetKey(0);
+		return Current;
+	}
+	
+	// 3. 重启模块使新速率生效，KEY拉低使其以透传模式启动
+	HC05_Command("AT+RESET\r\n", "OK");
+	HC05_SetKey(0);
+	Delay_ms(HC05_RESET_DELAY);
+	
+	// 4. 以目标速率验证
+	HC05_SetKey(1);
+	Delay_ms(50);
+	if(HC05_Probe(TargetBaud)){
+		HC05_SetKey(0);
+		return TargetBaud;
+	}
+	if(HC05_Probe(Current)){  // 模块未切换，沿用原速率
+		HC05_SetKey(0);
+		return Current;
+	}
+	HC05_SetKey(0);
+	Serial_SetBaudRate(HC05_DEFAULT_BAUD);
+	return HC05_DEFAULT_BAUD;
+}
+
+
+/**
+ * @brief 与HC-05协商串口波特率
+ * @param TargetBaud 目标波特率
+ * @retval 协商后USART1实际使用的波特率
+ * @note 设置写入模块Flash，两端各自协商，蓝牙链路两侧的串口速率互不影响。
+ *       热启动时蓝牙可能仍处于连接状态，模块不再应答AT，因此直接沿用备份寄存器中
+ *       上次的协商结果。需在Serial_Init、Timer_Init之后、Watchdog_Init之前调用，
+ *       冷启动最长耗时约2秒
+ */
+uint32_t HC05_Negotiate(uint32_t TargetBaud){
+	uint8_t WarmStart = Watchdog_IsWarmStart();  // 同时开启备份寄存器的时钟和访问
+	uint32_t BaudRate = (uint32_t)BKP_ReadBackupRegister(HC05_BKP_DR) * 100;
+	
+	if(WarmStart && BaudRate != 0){
+		Serial_SetBaudRate(BaudRate);
+		return BaudRate;
+	}
+	
+	BaudRate = HC05_DoNegotiate(TargetBaud);
+	BKP_WriteBackupRegister(HC05_BKP_DR, (uint16_t)(BaudRate / 100));
+	return BaudRate;
+}
@@ -0,0 +1,16 @@
+#ifndef __HC05_H
+#define __HC05_H
+
+#include <stdint.h>
+
+/**
+ * @brief HC-05串口波特率配置
+ * @note HC05_TARGET_BAUD可选115200/230400/460800，协商失败时回退到HC05_DEFAULT_BAUD
+ */
+#define HC05_TARGET_BAUD	115200
+#define HC05_DEFAULT_BAUD	9600
+
+void HC05_Init(void);
+uint32_t HC05_Negotiate(uint32_t TargetBaud);
+
+#endif
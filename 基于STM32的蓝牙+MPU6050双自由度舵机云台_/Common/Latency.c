@@ -0,0 +1,280 @@
+#include "Latency.h"
+
+/**
+ * @brief 帧龄直方图区间上界（us）：<2ms <5ms <10ms <20ms <50ms <100ms <200ms >=200ms
+ */
+const uint32_t Latency_HistEdge[LATENCY_HIST_NUM - 1] = {2000, 5000, 10000, 20000, 50000, 100000, 200000};
+
+/**
+  * @brief  由微秒计数生成16位时间戳
+  * @param  Micros 微秒计数
+  * @retval 时间戳，单位为2^LATENCY_STAMP_SHIFT微秒
+  * @note   移位而不是除法，32位计数回绕时时间戳也连续回绕
+  */
+uint16_t Latency_Stamp(uint32_t Micros)
+{
+	return (uint16_t)(Micros >> LATENCY_STAMP_SHIFT);
+}
+
+/**
+  * @brief  时延测量初始化
+  * @param  Lat 时延测量
+  * @retval 无
+  */
+void Latency_Init(Latency *Lat)
+{
+	uint8_t i;
+	
+	Lat->Pending = 0;
+	Lat->PingTime = 0;
+	Lat->Samples = 0;
+	Lat->Timeouts = 0;
+	Lat->Rtt = 0;
+	Lat->RttMin = 0xFFFFFFFF;
+	Lat->RttMax = 0;
+	Lat->RttAvg = 0;
+	Lat->OffsetValid = 0;
+	Lat->Offset = 0;
+	Lat->SyncTime = 0;
+	Lat->RefValid = 0;
+	Lat->RefOffset = 0;
+	Lat->RefTime = 0;
+	Lat->WindowCount = 0;
+	Lat->BestRtt = 0;
+	Lat->BestOffset = 0;
+	Lat->BestTime = 0;
+	Lat->DriftValid = 0;
+	Lat->Drift = 0;
+	Lat->SyncError = 0;
+	Lat->Resyncs = 0;
+	Lat->Age = 0;
+	Lat->AgeAvg = 0;
+	for (i = 0; i < LATENCY_HIST_NUM; i ++)
+	{
+		Lat->Hist[i] = 0;
+	}
+}
+
+/**
+  * @brief  按频率偏差外推某一本端时间的时钟偏差
+  * @param  Lat 时延测量
+  * @param  Local 本端时间（us）
+  * @retval 时钟偏差（us，按2^32取模）
+  */
+static uint32_t Latency_OffsetAt(const Latency *Lat, uint32_t Local)
+{
+	int32_t Elapsed = (int32_t)(Local - Lat->SyncTime);
+	
+	return Lat->Offset + (uint32_t)(int32_t)((int64_t)Lat->Drift * Elapsed / 1000000000);
+}
+
+/**
+  * @brief  用一次时钟偏差测量更新偏差和频率偏差
+  * @param  Lat 时延测量
+  * @param  Measured 测得的时钟偏差（us）
+  * @param  Local 测量对应的本端时间（us）
+  * @retval 无
+  * @note   第一次（或重新同步后的第一次）测量作为基准点；频率偏差由本次测量与基准点之差除以间隔得到，间隔越长，单次测量误差的影响越小，
+  *         间隔不足LATENCY_DRIFT_BASE时不估计；间隔超过LATENCY_DRIFT_SPAN时基准点前移一半，
+  *         避免32位时间回绕；偏差每次修正预测误差的一半；误差超过LATENCY_SYNC_STEP
+  *         说明发送端复位或时钟跳变，重新开始
+  */
+static void Latency_Sync(Latency *Lat, uint32_t Measured, uint32_t Local)
+{
+	uint32_t Elapsed = Local - Lat->RefTime;
+	int32_t Error;
+	int32_t Drift;
+	
+	if (Lat->RefValid)
+	{
+		Error = (int32_t)(Measured - Latency_OffsetAt(Lat, Local));
+		Lat->SyncError = Error;
+		if (Error > LATENCY_SYNC_STEP || Error < -LATENCY_SYNC_STEP)
+		{
+			Lat->RefValid = 0;
+			Lat->Resyncs ++;
+		}
+	}
+	if (!Lat->RefValid)
+	{
+		Lat->Offset = Measured;
+		Lat->SyncTime = Local;
+		Lat->RefOffset = Measured;
+		Lat->RefTime = Local;
+		Lat->RefValid = 1;
+		Lat->DriftValid = 0;
+		Lat->Drift = 0;
+		return;
+	}
+	
+	Lat->Offset = Latency_OffsetAt(Lat, Local) + (uint32_t)(Error / 2);
+	Lat->SyncTime = Local;
+	if (Elapsed >= LATENCY_DRIFT_BASE)
+	{
+		Drift = (int32_t)((int64_t)(int32_t)(Measured - Lat->RefOffset) * 1000000000 / Elapsed);
+		if (Drift > LATENCY_DRIFT_MAX) {Drift = LATENCY_DRIFT_MAX;}
+		if (Drift < -LATENCY_DRIFT_MAX) {Drift = -LATENCY_DRIFT_MAX;}
+		Lat->Drift = Drift;
+		Lat->DriftValid = 1;
+	}
+	if (Elapsed >= LATENCY_DRIFT_SPAN)
+	{
+		Lat->RefTime += Elapsed / 2;
+		Lat->RefOffset = Latency_OffsetAt(Lat, Lat->RefTime);
+	}
+}
+
+/**
+  * @brief  需要时生成PING消息
+  * @param  Lat 时延测量
+  * @param  Now 当前时间（us）
+  * @param  Ping 输出的PING消息体
+  * @retval 1表示需要发送，0表示本次无需发送
+  * @note   每LATENCY_PING_INTERVAL发送一次；同一时间只有一个PING在途，超时未应答计入Timeouts
+  */
+uint8_t Latency_MakePing(Latency *Lat, uint32_t Now, MsgPing *Ping)
+{
+	if (Lat->Pending)
+	{
+		if (Now - Lat->PingTime < LATENCY_PING_TIMEOUT) {return 0;}
+		Lat->Pending = 0;
+		Lat->Timeouts ++;
+	}
+	else if (Lat->Samples + Lat->Timeouts > 0 && Now - Lat->PingTime < LATENCY_PING_INTERVAL)
+	{
+		return 0;
+	}
+	
+	Lat->Pending = 1;
+	Lat->PingTime = Now;
+	Ping->T0 = Now;
+	return 1;
+}
+
+/**
+  * @brief  对收到的PING生成PONG消息（发送端调用）
+  * @param  Ping PING消息体
+  * @param  RxTime PING的接收时间（us）
+  * @param  Now 当前时间（us）
+  * @param  Pong 输出的PONG消息体
+  * @retval 无
+  * @note   同时带回收到时间和应答时间，接收端据此扣除本端的处理延时
+  */
+void Latency_MakePong(const MsgPing *Ping, uint32_t RxTime, uint32_t Now, MsgPong *Pong)
+{
+	Pong->T0 = Ping->T0;
+	Pong->T1 = RxTime;
+	Pong->T2 = Now;
+}
+
+/**
+  * @brief  处理收到的PONG消息
+  * @param  Lat 时延测量
+  * @param  Pong PONG消息体
+  * @param  RxTime PONG的接收时间（us）
+  * @retval 无
+  * @note   只接受应答最近一次PING的PONG；第一个PONG直接给出粗略的时钟偏差，供尽早统计帧龄，
+  *         之后每组取往返时延最小的样本更新时钟偏差和频率偏差
+  */
+void Latency_OnPong(Latency *Lat, const MsgPong *Pong, uint32_t RxTime)
+{
+	uint32_t Rtt;
+	
+	if (!Lat->Pending || Pong->T0 != Lat->PingTime) {return;}
+	Lat->Pending = 0;
+	
+	Rtt = (RxTime - Pong->T0) - (Pong->T2 - Pong->T1);
+	if (Rtt >= 0x80000000) {Rtt = 0;}			//两端计时误差导致的负值
+	Lat->Rtt = Rtt;
+	if (Rtt < Lat->RttMin) {Lat->RttMin = Rtt;}
+	if (Rtt > Lat->RttMax) {Lat->RttMax = Rtt;}
+	Lat->RttAvg = Lat->Samples == 0 ? Rtt : Lat->RttAvg - (Lat->RttAvg >> 3) + (Rtt >> 3);
+	Lat->Samples ++;
+	
+	if (Lat->WindowCount == 0 || Rtt < Lat->BestRtt)
+	{
+		Lat->BestRtt = Rtt;
+		Lat->BestOffset = (Pong->T1 - Pong->T0) - Rtt / 2;	//假设去程为往返的一半
+		Lat->BestTime = Pong->T0 + Rtt / 2;
+	}
+	Lat->WindowCount ++;
+	if (!Lat->OffsetValid)
+	{
+		Lat->Offset = Lat->BestOffset;
+		Lat->SyncTime = Lat->BestTime;
+		Lat->OffsetValid = 1;
+	}
+	if (Lat->WindowCount >= LATENCY_SYNC_WINDOW)
+	{
+		Latency_Sync(Lat, Lat->BestOffset, Lat->BestTime);
+		Lat->WindowCount = 0;
+	}
+}
+
+/**
+  * @brief  由角度消息的发送端时间戳更新帧龄统计
+  * @param  Lat 时延测量
+  * @param  Stamp 发送端采样时的16位时间戳
+  * @param  Now 当前时间（us，接收端时钟）
+  * @retval 无
+  * @note   尚未得到时钟偏差时不统计
+  */
+void Latency_OnStamp(Latency *Lat, uint16_t Stamp, uint32_t Now)
+{
+	uint32_t Age;
+	uint8_t i;
+	
+	if (!Lat->OffsetValid) {return;}
+	Age = Now - Latency_StampToLocal(Lat, Stamp, Now);
+	if (Age >= 0x80000000) {Age = 0;}			//时钟偏差误差导致的负值
+	
+	Lat->Age = Age;
+	Lat->AgeAvg = Lat->AgeAvg - (Lat->AgeAvg >> 3) + (Age >> 3);
+	for (i = 0; i < LATENCY_HIST_NUM - 1; i ++)
+	{
+		if (Age < Latency_HistEdge[i]) {break;}
+	}
+	Lat->Hist[i] ++;
+}
+
+/**
+  * @brief  本端时间换算为发送端时间
+  * @param  Lat 时延测量
+  * @param  Local 本端时间（us）
+  * @retval 同一时刻的发送端时间（us）；尚未同步时原样返回
+  */
+uint32_t Latency_LocalToRemote(const Latency *Lat, uint32_t Local)
+{
+	if (!Lat->OffsetValid) {return Local;}
+	return Local + Latency_OffsetAt(Lat, Local);
+}
+
+/**
+  * @brief  发送端时间换算为本端时间
+  * @param  Lat 时延测量
+  * @param  Remote 发送端时间（us）
+  * @retval 同一时刻的本端时间（us）；尚未同步时原样返回
+  * @note   先用不含频率偏差的偏差得到近似的本端时间，再按该时间外推偏差；
+  *         近似带来的误差为频率偏差与时钟偏差之积，可以忽略
+  */
+uint32_t Latency_RemoteToLocal(const Latency *Lat, uint32_t Remote)
+{
+	if (!Lat->OffsetValid) {return Remote;}
+	return Remote - Latency_OffsetAt(Lat, Remote - Lat->Offset);
+}
+
+/**
+  * @brief  16位发送端时间戳换算为本端时间
+  * @param  Lat 时延测量
+  * @param  Stamp 发送端时间戳（Latency_Stamp）
+  * @param  Now 当前本端时间（us）
+  * @retval 时间戳对应的本端时间（us），精度为时间戳单位
+  * @note   时间戳只有16位，按离当前时刻最近（前后约4.2s内）展开为完整的发送端时间
+  */
+uint32_t Latency_StampToLocal(const Latency *Lat, uint16_t Stamp, uint32_t Now)
+{
+	uint32_t Remote = Latency_LocalToRemote(Lat, Now) >> LATENCY_STAMP_SHIFT;
+	
+	Remote += (uint32_t)(int32_t)(int16_t)(Stamp - (uint16_t)Remote);
+	return Latency_RemoteToLocal(Lat, Remote << LATENCY_STAMP_SHIFT);
+}
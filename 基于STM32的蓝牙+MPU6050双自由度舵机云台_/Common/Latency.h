@@ -0,0 +1,66 @@
+#ifndef __LATENCY_H
+#define __LATENCY_H
+
+#include <stdint.h>
+#include "Message.h"
+
+#define LATENCY_STAMP_SHIFT		7			//16位时间戳 = 微秒计数 >> 7，单位128us，约8.4s回绕
+#define LATENCY_PING_INTERVAL	500000		//时延探测间隔（us）
+#define LATENCY_PING_TIMEOUT	1000000		//时延应答超时（us）
+#define LATENCY_HIST_NUM		8			//帧龄直方图区间数
+#define LATENCY_SYNC_WINDOW		8			//每组PONG中取往返时延最小的一个更新时钟偏差
+#define LATENCY_DRIFT_BASE		10000000	//估计频率偏差所需的最短测量间隔（us）
+#define LATENCY_DRIFT_SPAN		0x40000000	//频率偏差基准点的最长间隔（us，约18分钟）
+#define LATENCY_DRIFT_MAX		200000		//频率偏差上限（ppb），超出视为测量错误
+#define LATENCY_SYNC_STEP		50000		//偏差测量与预测相差超过此值（us）时重新同步
+
+/**
+ * @brief 时延测量（接收端）
+ * @note 往返时延按NTP方式计算：t0接收端发出PING，t1发送端收到，t2发送端发出PONG，t3接收端收到，
+ *       RTT = (t3 - t0) - (t2 - t1)，时钟偏差 = ((t1 - t0) + (t2 - t3)) / 2（发送端时钟 - 接收端时钟）；
+ *       有了时钟偏差，角度消息中的发送端时间戳可换算为帧龄（从发送端采样到接收端使用的时间）；
+ *       去程和回程时延不对称是偏差误差的主要来源，往返时延最小的样本两程都接近最小值、最对称，
+ *       因此每LATENCY_SYNC_WINDOW个PONG只取往返时延最小的一个；两端晶振频率不同，偏差随时间线性变化，
+ *       频率偏差由当前测量与较早的基准点之差得到，两次测量之间按频率偏差外推
+ */
+typedef struct {
+	uint8_t Pending;					//已发出PING，等待PONG
+	uint32_t PingTime;					//最近一次PING的发起时间t0
+	uint32_t Samples;					//有效PONG数
+	uint32_t Timeouts;					//超时未应答的PING数
+	uint32_t Rtt;						//最近一次往返时延（us）
+	uint32_t RttMin;					//最小往返时延（us）
+	uint32_t RttMax;					//最大往返时延（us）
+	uint32_t RttAvg;					//往返时延滑动平均（us，系数1/8）
+	uint8_t OffsetValid;				//时钟偏差有效
+	uint32_t Offset;					//时钟偏差（us，按2^32取模），发送端时钟 - 接收端时钟
+	uint32_t SyncTime;					//Offset对应的本端时间（us）
+	uint8_t RefValid;					//已有频率偏差基准点（至少完成一组测量）
+	uint32_t RefOffset;					//频率偏差基准点的时钟偏差（us）
+	uint32_t RefTime;					//基准点的本端时间（us）
+	uint8_t WindowCount;				//本组已收到的PONG数
+	uint32_t BestRtt;					//本组最小往返时延（us）
+	uint32_t BestOffset;				//该样本测得的时钟偏差（us）
+	uint32_t BestTime;					//该样本对应的本端时间（us）
+	uint8_t DriftValid;					//频率偏差有效
+	int32_t Drift;						//频率偏差（ppb），正值表示发送端时钟走得快
+	int32_t SyncError;					//最近一次偏差测量与预测之差（us）
+	uint32_t Resyncs;					//偏差跳变而重新同步的次数（发送端复位等）
+	uint32_t Age;						//最近一帧角度的帧龄（us）
+	uint32_t AgeAvg;					//帧龄滑动平均（us，系数1/8）
+	uint32_t Hist[LATENCY_HIST_NUM];	//帧龄直方图
+} Latency;
+
+extern const uint32_t Latency_HistEdge[LATENCY_HIST_NUM - 1];
+
+uint16_t Latency_Stamp(uint32_t Micros);
+void Latency_Init(Latency *Lat);
+uint8_t Latency_MakePing(Latency *Lat, uint32_t Now, MsgPing *Ping);
+void Latency_MakePong(const MsgPing *Ping, uint32_t RxTime, uint32_t Now, MsgPong *Pong);
+void Latency_OnPong(Latency *Lat, const MsgPong *Pong, uint32_t RxTime);
+void Latency_OnStamp(Latency *Lat, uint16_t Stamp, uint32_t Now);
+uint32_t Latency_LocalToRemote(const Latency *Lat, uint32_t Local);
+uint32_t Latency_RemoteToLocal(const Latency *Lat, uint32_t Remote);
+uint32_t Latency_StampToLocal(const Latency *Lat, uint16_t Stamp, uint32_t Now);
+
+#endif
@@ -0,0 +1,238 @@
+#include <string.h>
+#include "Link.h"
+#include "Crc.h"
+
+/**
+  * @brief  COBS编码一帧并在末尾加上定界符
+  * @param  Data 载荷
+  * @param  Length 载荷长度，范围：1~LINK_MAX_FRAME
+  * @param  Out 输出缓冲区，至少Length+2字节
+  * @retval 输出的字节数（含定界符）
+  * @note   每段不含0x00的数据前放一个编码字节，值为到下一个0x00（或段尾）的距离，
+  *         原数据中的0x00由编码字节隐含表示，因此输出中只有末尾的定界符为0x00
+  */
+uint8_t Link_Encode(const uint8_t *Data, uint8_t Length, uint8_t *Out)
+{
+	uint8_t CodeIndex = 0;				//当前编码字节在Out中的位置
+	uint8_t Code = 1;
+	uint8_t Index = 1;
+	uint8_t i;
+	
+	for (i = 0; i < Length; i ++)
+	{
+		if (Data[i] == 0x00)
+		{
+			Out[CodeIndex] = Code;		//遇到0x00，结束当前数据块
+			CodeIndex = Index ++;
+			Code = 1;
+		}
+		else
+		{
+			Out[Index ++] = Data[i];
+			Code ++;
+			if (Code == 0xFF)			//数据块满254字节，强制开始新块
+			{
+				Out[CodeIndex] = Code;
+				CodeIndex = Index ++;
+				Code = 1;
+			}
+		}
+	}
+	Out[CodeIndex] = Code;
+	Out[Index ++] = LINK_DELIMITER;
+	return Index;
+}
+
+/**
+  * @brief  解码器初始化
+  * @param  Decoder 解码器
+  * @retval 无
+  */
+void Link_DecoderInit(LinkDecoder *Decoder)
+{
+	Decoder->Code = 0xFF;
+	Decoder->Remain = 0;
+	Decoder->Length = 0;
+	Decoder->Error = 0;
+	Decoder->Errors = 0;
+}
+
+/**
+  * @brief  丢弃当前帧，等待下一个定界符重新同步
+  * @param  Decoder 解码器
+  * @retval 无
+  * @note   接收数据有缺口（缓冲区溢出、暂停接收）时调用，缺口所在的帧计入Errors
+  */
+void Link_DecoderResync(LinkDecoder *Decoder)
+{
+	Decoder->Error = 1;
+}
+
+/**
+  * @brief  输入一个接收字节
+  * @param  Decoder 解码器
+  * @param  Byte 接收到的字节
+  * @retval 收到定界符且帧有效时返回载荷长度，载荷在Decoder->Data中；否则返回0
+  * @note   返回的载荷在下一次调用前有效；空帧（连续定界符）不计错误，可用于发送端主动重同步
+  */
+uint8_t Link_Decode(LinkDecoder *Decoder, uint8_t Byte)
+{
+	uint8_t Length;
+	
+	if (Byte == LINK_DELIMITER)
+	{
+		Length = Decoder->Length;
+		if (Decoder->Remain != 0 || Decoder->Error)	//数据块未收完或帧中途出错
+		{
+			Length = 0;
+			Decoder->Errors ++;
+		}
+		Decoder->Code = 0xFF;
+		Decoder->Remain = 0;
+		Decoder->Length = 0;
+		Decoder->Error = 0;
+		return Length;
+	}
+	
+	if (Decoder->Error) {return 0;}
+	
+	if (Decoder->Remain == 0)			//编码字节
+	{
+		if (Decoder->Code != 0xFF)		//上一块不满254字节，说明其后是一个原始0x00
+		{
+			if (Decoder->Length >= LINK_MAX_FRAME) {Decoder->Error = 1; return 0;}
+			Decoder->Data[Decoder->Length ++] = 0x00;
+		}
+		Decoder->Code = Byte;
+		Decoder->Remain = Byte - 1;
+	}
+	else								//数据字节
+	{
+		if (Decoder->Length >= LINK_MAX_FRAME) {Decoder->Error = 1; return 0;}
+		Decoder->Data[Decoder->Length ++] = Byte;
+		Decoder->Remain --;
+	}
+	return 0;
+}
+
+/**
+  * @brief  组装数据包（序号 + 数据 + CRC-16）并COBS编码
+  * @param  Seq 序号
+  * @param  Data 数据
+  * @param  Length 数据长度，范围：1~LINK_MAX_DATA，超出部分被截断
+  * @param  Out 输出缓冲区，至少LINK_MAX_ENCODED字节
+  * @retval 输出的字节数（含定界符）
+  */
+uint8_t Link_Pack(uint8_t Seq, const uint8_t *Data, uint8_t Length, uint8_t *Out)
+{
+	uint8_t Packet[LINK_MAX_PAYLOAD];
+	uint16_t Crc;
+	
+	if (Length > LINK_MAX_DATA) {Length = LINK_MAX_DATA;}
+	Packet[0] = Seq;
+	memcpy(&Packet[1], Data, Length);
+	Crc = Crc16(Packet, Length + 1);
+	Packet[Length + 1] = (uint8_t)Crc;
+	Packet[Length + 2] = (uint8_t)(Crc >> 8);
+	return Link_Encode(Packet, Length + LINK_OVERHEAD, Out);
+}
+
+/**
+  * @brief  接收统计初始化
+  * @param  Stats 接收统计
+  * @retval 无
+  */
+void Link_StatsInit(LinkStats *Stats)
+{
+	memset(Stats, 0, sizeof(LinkStats));
+}
+
+/**
+  * @brief  链路质量滑动平均：每个按序号应到的包计一次，到达为100%，丢失为0%
+  * @param  Stats 接收统计
+  * @param  Good 1表示到达，0表示丢失
+  * @retval 无
+  */
+static void Link_QualityUpdate(LinkStats *Stats, uint8_t Good)
+{
+	Stats->Quality -= Stats->Quality >> LINK_QUALITY_SHIFT;
+	if (Good) {Stats->Quality += 10000 >> LINK_QUALITY_SHIFT;}
+}
+
+/**
+  * @brief  校验解码后的数据包并更新接收统计
+  * @param  Stats 接收统计
+  * @param  Packet Link_Decode解码出的数据包
+  * @param  Length 数据包长度
+  * @retval 数据长度，数据位于Packet+1；包应丢弃时返回0
+  * @note   CRC错误、重复和迟到的包都被丢弃；序号缺口计入Lost，链路质量按序号统计，
+  *         CRC错误的包只在缺口中计一次；连续LINK_REORDER_LIMIT个旧序号视为对端复位；
+  *         校验帧同样返回0但不计为CRC错误，由调用者用Link_IsParity识别后交给Fec_Repair
+  */
+uint8_t Link_Check(LinkStats *Stats, const uint8_t *Packet, uint8_t Length)
+{
+	uint8_t Delta;
+	uint16_t Crc, Stored;
+	
+	if (Length <= LINK_OVERHEAD || Length > LINK_MAX_PAYLOAD)
+	{
+		if (!Link_IsParity(Packet, Length)) {Stats->CrcErrors ++;}
+		return 0;
+	}
+	Crc = Crc16(Packet, Length - 2);
+	Stored = (uint16_t)(Packet[Length - 2] | (Packet[Length - 1] << 8));
+	if (Crc != Stored)
+	{
+		if ((Crc ^ LINK_PARITY_MASK) != Stored) {Stats->CrcErrors ++;}
+		return 0;
+	}
+	
+	Delta = (uint8_t)(Packet[0] - Stats->LastSeq);
+	if (Stats->Synced)
+	{
+		if (Delta == 0)
+		{
+			Stats->Duplicates ++;
+			return 0;
+		}
+		if (Delta >= 0x80)
+		{
+			Stats->Reordered ++;
+			if (++ Stats->OldRun < LINK_REORDER_LIMIT) {return 0;}
+			Delta = 1;					//对端复位后序号重新开始，按新序列接受
+		}
+		Stats->Lost += Delta - 1;
+		while (-- Delta) {Link_QualityUpdate(Stats, 0);}
+	}
+	Stats->Synced = 1;
+	Stats->OldRun = 0;
+	Stats->LastSeq = Packet[0];
+	Stats->Received ++;
+	Link_QualityUpdate(Stats, 1);
+	return Length - LINK_OVERHEAD;
+}
+
+/**
+  * @brief  判断解码出的帧是否为校验帧
+  * @param  Frame Link_Decode解码出的帧
+  * @param  Length 帧长度
+  * @retval 1表示校验帧，0表示不是
+  * @note   校验帧的CRC与LINK_PARITY_MASK异或，同一内容的两种CRC必不相同，
+  *         数据包不会被误认为校验帧，反之亦然
+  */
+uint8_t Link_IsParity(const uint8_t *Frame, uint8_t Length)
+{
+	if (Length <= LINK_PARITY_OVERHEAD) {return 0;}
+	return (uint16_t)(Crc16(Frame, Length - 2) ^ LINK_PARITY_MASK)
+	       == (uint16_t)(Frame[Length - 2] | (Frame[Length - 1] << 8));
+}
+
+/**
+  * @brief  获取链路质量
+  * @param  Stats 接收统计
+  * @retval 最近约16个应到数据包的到达率，0~100（%）
+  */
+uint8_t Link_Quality(const LinkStats *Stats)
+{
+	return (uint8_t)(Stats->Quality / 100);
+}
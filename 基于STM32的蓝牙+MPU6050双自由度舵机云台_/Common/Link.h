@@ -0,0 +1,59 @@
+#ifndef __LINK_H
+#define __LINK_H
+
+#include <stdint.h>
+
+#define LINK_DELIMITER		0x00		//帧定界符，编码后的数据中不会出现该字节
+#define LINK_MAX_PAYLOAD	32			//数据包最大长度
+#define LINK_OVERHEAD		3			//数据包开销：1字节序号 + 2字节CRC-16
+#define LINK_MAX_DATA		(LINK_MAX_PAYLOAD - LINK_OVERHEAD)	//单个数据包最大数据字节数
+
+#define LINK_PARITY_MASK	0xA55A		//校验帧的CRC与此值异或，与数据包区分（见Fec.h）
+#define LINK_PARITY_OVERHEAD	4		//校验帧开销：[首序号][个数|长度异或] + 2字节CRC-16
+#define LINK_MAX_FRAME		(LINK_MAX_DATA + LINK_PARITY_OVERHEAD)	//单帧最大载荷字节数（数据包或校验帧）
+#define LINK_MAX_ENCODED	(LINK_MAX_FRAME + 2)	//编码后最大长度：1字节开销 + 载荷 + 1字节定界符（载荷不超过254字节）
+#define LINK_REORDER_LIMIT	4			//连续收到这么多"旧"序号时认为对端已复位，重新同步序号
+#define LINK_QUALITY_SHIFT	4			//链路质量滑动平均系数：1/16
+
+/**
+ * @brief COBS流式解码器
+ * @note 每收到一个字节调用一次Link_Decode；任何字节丢失或错误最多只损坏当前帧，
+ *       下一个定界符处即恢复同步
+ */
+typedef struct {
+	uint8_t Code;						//当前数据块的编码字节
+	uint8_t Remain;						//当前数据块剩余的数据字节数，为0时下一字节为编码字节
+	uint8_t Length;						//已解码字节数
+	uint8_t Error;						//当前帧已出错，丢弃至下一个定界符
+	uint32_t Errors;					//出错丢弃的帧数
+	uint8_t Data[LINK_MAX_FRAME];		//解码后的载荷
+} LinkDecoder;
+
+/**
+ * @brief 数据包接收统计
+ * @note 数据包格式：[序号][数据...][CRC-16低8位][CRC-16高8位]，CRC覆盖序号和数据
+ */
+typedef struct {
+	uint8_t Synced;						//已收到过有效数据包
+	uint8_t LastSeq;					//最近接受的序号
+	uint8_t OldRun;						//连续收到旧序号的次数
+	uint16_t Quality;					//链路质量，0~10000对应0.00%~100.00%
+	uint32_t Received;					//接受的数据包数
+	uint32_t CrcErrors;					//CRC错误或长度不足而丢弃的包数
+	uint32_t Lost;						//序号缺口累计丢失的包数（含CRC错误的包）
+	uint32_t Duplicates;				//重复序号而丢弃的包数
+	uint32_t Reordered;					//序号倒退（迟到）而丢弃的包数
+} LinkStats;
+
+uint8_t Link_Encode(const uint8_t *Data, uint8_t Length, uint8_t *Out);
+void Link_DecoderInit(LinkDecoder *Decoder);
+void Link_DecoderResync(LinkDecoder *Decoder);
+uint8_t Link_Decode(LinkDecoder *Decoder, uint8_t Byte);
+
+uint8_t Link_Pack(uint8_t Seq, const uint8_t *Data, uint8_t Length, uint8_t *Out);
+void Link_StatsInit(LinkStats *Stats);
+uint8_t Link_Check(LinkStats *Stats, const uint8_t *Packet, uint8_t Length);
+uint8_t Link_IsParity(const uint8_t *Frame, uint8_t Length);
+uint8_t Link_Quality(const LinkStats *Stats);
+
+#endif
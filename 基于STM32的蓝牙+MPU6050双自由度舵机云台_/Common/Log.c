@@ -0,0 +1,63 @@
+#include "Log.h"
+
+/**
+  * @brief  日志环形缓冲区
+  * @note   每条日志为[参数个数][格式字符串地址][参数...]，按32位字存放，写入和取出都在主循环中进行
+  */
+static uint32_t Log_Buffer[LOG_BUFFER_WORDS];
+static uint16_t Log_Head;				//下一个写入位置
+static uint16_t Log_Tail;				//下一个取出位置
+uint32_t Log_Dropped;					//缓冲区满而丢弃的日志条数
+
+/**
+  * @brief  写入一条日志
+  * @param  Fmt 格式字符串的地址
+  * @param  Arg 参数
+  * @param  Count 参数个数，超过LOG_MAX_ARGS的部分被截去
+  * @retval 无
+  * @note   由LOG宏调用；只复制几个字，耗时为微秒级；缓冲区空间不足时整条丢弃
+  */
+void Log_Write(uint32_t Fmt, const uint32_t *Arg, uint8_t Count)
+{
+	uint16_t Used = (Log_Head - Log_Tail + LOG_BUFFER_WORDS) % LOG_BUFFER_WORDS;
+	uint8_t i;
+	
+	if (Count > LOG_MAX_ARGS) {Count = LOG_MAX_ARGS;}
+	if (Used + Count + 2 > LOG_BUFFER_WORDS - 1)
+	{
+		Log_Dropped ++;
+		return;
+	}
+	
+	Log_Buffer[Log_Head] = Count;
+	Log_Head = (Log_Head + 1) % LOG_BUFFER_WORDS;
+	Log_Buffer[Log_Head] = Fmt;
+	Log_Head = (Log_Head + 1) % LOG_BUFFER_WORDS;
+	for (i = 0; i < Count; i ++)
+	{
+		Log_Buffer[Log_Head] = Arg[i];
+		Log_Head = (Log_Head + 1) % LOG_BUFFER_WORDS;
+	}
+}
+
+/**
+  * @brief  取出最早的一条日志
+  * @param  Out 输出[格式字符串地址][参数...]，至少LOG_MAX_ARGS+1个字
+  * @retval 输出的字节数，0表示没有日志
+  * @note   输出即MSG_LOG的消息体
+  */
+uint8_t Log_Pop(uint32_t *Out)
+{
+	uint8_t Count, i;
+	
+	if (Log_Tail == Log_Head) {return 0;}
+	
+	Count = (uint8_t)Log_Buffer[Log_Tail];
+	Log_Tail = (Log_Tail + 1) % LOG_BUFFER_WORDS;
+	for (i = 0; i <= Count; i ++)
+	{
+		Out[i] = Log_Buffer[Log_Tail];
+		Log_Tail = (Log_Tail + 1) % LOG_BUFFER_WORDS;
+	}
+	return (Count + 1) * 4;
+}
@@ -0,0 +1,31 @@
+#ifndef __LOG_H
+#define __LOG_H
+
+#include <stdint.h>
+
+#define LOG_MAX_ARGS		5			//单条日志最多参数个数
+#define LOG_BUFFER_WORDS	256			//日志环形缓冲区大小（32位字），需容纳一次统计请求的全部报告
+											//（接收端链路统计加循环监测约170字，任务数达到MONITOR_TASK_MAX时约190字）
+
+/**
+ * @brief 记录一条日志
+ * @note 日志点只写入格式字符串的地址和原始参数（均为32位），不在单片机上格式化；
+ *       格式字符串留在Flash中，主机端工具（Tools/log_decode.py）从编译生成的.axf中按地址取回
+ *       并完成格式化；参数只支持整数和常量字符串（%s按地址从.axf中读取）；
+ *       格式字符串沿用printf写法，以"\r\n"结束一行，未结束的日志与下一条拼接显示；
+ *       只能在主循环中调用，不可在中断中调用
+ */
+#define LOG(Fmt, ...)															\
+	do {																		\
+		static const char Log_Fmt[] = Fmt;										\
+		const uint32_t Log_Arg[] = {0, __VA_ARGS__};							\
+		Log_Write((uint32_t)(uintptr_t)Log_Fmt, &Log_Arg[1],						\
+		          sizeof(Log_Arg) / sizeof(Log_Arg[0]) - 1);					\
+	} while (0)
+
+extern uint32_t Log_Dropped;
+
+void Log_Write(uint32_t Fmt, const uint32_t *Arg, uint8_t Count);
+uint8_t Log_Pop(uint32_t *Out);
+
+#endif
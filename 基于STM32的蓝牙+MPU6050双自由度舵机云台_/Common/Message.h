@@ -0,0 +1,176 @@
+#ifndef __MESSAGE_H
+#define __MESSAGE_H
+
+#include <stdint.h>
+#include "AngleCodec.h"
+#include "Param.h"
+#include "Log.h"
+#include "QuatCodec.h"
+#include "Proto.h"
+
+/**
+ * @brief 消息类型（TLV中的T），数据包格式见Proto.h
+ * @note 已分配的编号和消息体中已有字段的含义不再改变；新增字段只追加在消息体末尾，
+ *       旧版本按自己认识的长度读取，新版本对较短的旧消息体按缺省值处理
+ */
+#define MSG_ANGLE			0x01		//角度，发送端->接收端
+#define MSG_PING			0x02		//时延探测，接收端->发送端
+#define MSG_PONG			0x03		//时延应答，发送端->接收端
+#define MSG_PARAM_GET		0x04		//读参数（配置）
+#define MSG_PARAM_SET		0x05		//写参数（配置），全部校验通过才一起生效
+#define MSG_PARAM_ACK		0x06		//参数应答，回读生效后的值
+#define MSG_QUAT			0x07		//压缩的姿态四元数，发送端->接收端，角度由接收端按自身结构换算
+#define MSG_TELEMETRY		0x08		//运行状态遥测，只经遥测串口发给主机
+#define MSG_HEARTBEAT		0x09		//心跳
+#define MSG_KEY_REQUEST		0x0A		//请求立即发送关键帧，接收端->发送端，无消息体
+#define MSG_ANGLE_BATCH		0x0B		//连续多个带时间戳的角度样本，发送端->接收端
+#define MSG_LOG				0x0C		//二进制日志，由主机端工具解码
+#define MSG_CREDIT			0x0D		//流控信用，接收端->发送端，见Flow.h
+#define MSG_SAMPLE			0x0E		//原始传感器样本，只经遥测串口发给主机
+#define MSG_LINK_REPORT		0x0F		//链路接收统计，接收端->发送端，用于自适应发送速率，见Rate.h
+#define MSG_STAT_REQUEST	0x10		//请求输出统计报告，只有目标节点应答（报告经遥测串口输出）
+
+/**
+ * @brief 心跳间隔（us）
+ * @note 发送端超过此时间没有发出任何消息时补发心跳，接收端据此区分"链路中断"与"没有新数据"，
+ *       接收端的链路超时需大于此值
+ */
+#define MSG_HEARTBEAT_INTERVAL	20000
+
+/**
+ * @brief 消息体定义
+ * @note 字段按自然对齐排列、无填充，小端；Proto_Dispatch保证交给处理函数的消息体4字节对齐，
+ *       可直接按结构体访问：数据包中的第一个消息体在接收队列槽内本身对齐（见FrameQueue.h），就地访问，
+ *       其后未对齐的消息体复制一次；变长消息只发送有效部分
+ */
+typedef struct {
+	uint16_t Stamp;						//采样时间戳（Latency_Stamp）
+	uint8_t Codec[ANGLE_MAX_LENGTH];	//AngleCodec关键帧或差分帧，实际长度 = 消息体长度 - 2
+} MsgAngle;
+#define MSG_ANGLE_LENGTH(n)	(2 + (n))	//差分帧长度为n时的角度消息体长度
+#define MSG_ANGLE_CODEC(Length)	((Length) - 2)	//角度消息体中差分帧的长度
+
+#define MSG_BATCH_MAX		4			//批量消息最多样本数
+
+typedef struct {
+	uint16_t Stamp;						//第一个样本的采样时间戳（Latency_Stamp）
+	uint8_t Count;						//样本数，1~MSG_BATCH_MAX
+	uint8_t Offset[MSG_BATCH_MAX];		//各样本相对Stamp的时间（时间戳单位），Offset[0]为0
+	uint8_t Reserved;					//保留，发送0
+	uint16_t Angle[MSG_BATCH_MAX][2];	//各样本的两个绝对角度（0.1°）
+} MsgAngleBatch;
+#define MSG_BATCH_LENGTH(n)	(8 + 4 * (n))	//n个样本的消息体长度，只发送有效样本
+
+typedef struct {
+	uint32_t Fmt;						//格式字符串在Flash中的地址
+	uint32_t Arg[LOG_MAX_ARGS];			//原始参数，实际个数 = 消息体长度 / 4 - 1
+} MsgLog;
+
+typedef struct {
+	uint8_t Acked;						//已处理的最新链路序号
+	uint8_t Window;						//允许在途（已发出、未确认）的数据包数
+} MsgCredit;
+
+typedef struct {
+	uint16_t Received;					//累计接受的数据包数（低16位，下同）
+	uint16_t Lost;						//累计丢失的数据包数（含CRC错误）
+	uint16_t CrcErrors;					//累计CRC错误数
+	uint16_t Overflow;					//累计串口溢出与接收缓冲区、队列溢出次数
+} MsgLinkReport;
+
+typedef struct {
+	uint8_t Reserved;					//保留，发送0，可省略
+} MsgStatRequest;
+
+typedef struct {
+	uint32_t T0;						//接收端发起时间
+} MsgPing;
+
+typedef struct {
+	uint32_t T0;						//回显的发起时间
+	uint32_t T1;						//发送端收到PING的时间
+	uint32_t T2;						//发送端发出PONG的时间
+} MsgPong;
+
+typedef struct {
+	uint8_t Dest;						//目标板，PARAM_DEST_SENDER或PARAM_DEST_RECEIVER
+	uint8_t Item[PARAM_ITEM_BYTES];		//读：{[编号]}...；写：{[编号][float]}...
+} MsgParam;
+
+typedef struct {
+	uint8_t Source;						//来源板
+	uint8_t Status;						//PARAM_OK或错误码
+	uint8_t Item[PARAM_ITEM_BYTES];		//{[编号][float]}...，回读的当前值
+} MsgParamAck;
+
+typedef struct {
+	uint16_t Stamp;						//采样时间戳（Latency_Stamp）
+	uint8_t Packed[QUAT_PACKED_LENGTH];	//最小三分量法压缩的四元数，格式见QuatCodec_Pack
+} MsgQuat;
+
+typedef struct {
+	uint32_t RttAvg;					//平均往返时延（us）
+	uint32_t AgeAvg;					//平均帧龄（us）
+	uint32_t Lost;						//累计丢包数
+	uint8_t Source;						//来源板
+	uint8_t Quality;					//链路质量（%）
+	uint16_t LoopMax;					//主循环最大周期（us，超过65535按65535）
+} MsgTelemetry;
+
+typedef struct {
+	uint32_t Uptime;					//运行时间（ms）
+	uint8_t Source;						//来源板
+	uint8_t State;						//运行状态，由各板定义
+	uint16_t Reserved;					//保留，发送0
+} MsgHeartbeat;
+
+typedef struct {
+	uint16_t Stamp;						//采样时间戳（Latency_Stamp）
+	int16_t Accel[3];					//加速度计原始值（X、Y、Z）
+	uint16_t Angle[2];					//滤波后的舵机目标角度（0.1°）
+} MsgSample;
+
+/**
+ * @brief 消息一览：X(类型, 消息体, 最小长度, 最大长度)
+ * @note 消息的唯一描述，两端的分发表和下方的布局检查都由它生成：
+ *       <类型>_MIN为最小长度，短于它的消息由Proto_Dispatch按格式错误丢弃；<类型>_LENGTH为最大长度；
+ *       新增消息时在此登记；用C编写的主机端工具包含本文件即得到相同的布局，Python工具使用
+ *       Tools/msg_layout.c按本文件导出并逐字段核对的格式（Tools/msg_layout.py）
+ */
+#define MSG_LIST(X)																		\
+	X(MSG_ANGLE,		MsgAngle,		MSG_ANGLE_LENGTH(1),	MSG_ANGLE_LENGTH(ANGLE_MAX_LENGTH))	\
+	X(MSG_PING,			MsgPing,		4,						4)							\
+	X(MSG_PONG,			MsgPong,		12,						12)							\
+	X(MSG_PARAM_GET,	MsgParam,		1,						1 + PARAM_ITEM_BYTES)		\
+	X(MSG_PARAM_SET,	MsgParam,		1,						1 + PARAM_ITEM_BYTES)		\
+	X(MSG_PARAM_ACK,	MsgParamAck,	2,						2 + PARAM_ITEM_BYTES)		\
+	X(MSG_QUAT,			MsgQuat,		2 + QUAT_PACKED_LENGTH,	2 + QUAT_PACKED_LENGTH)		\
+	X(MSG_TELEMETRY,	MsgTelemetry,	16,						16)							\
+	X(MSG_HEARTBEAT,	MsgHeartbeat,	0,						8)							\
+	X(MSG_ANGLE_BATCH,	MsgAngleBatch,	MSG_BATCH_LENGTH(1),	MSG_BATCH_LENGTH(MSG_BATCH_MAX))	\
+	X(MSG_LOG,			MsgLog,			4,						4 + 4 * LOG_MAX_ARGS)		\
+	X(MSG_CREDIT,		MsgCredit,		2,						2)							\
+	X(MSG_SAMPLE,		MsgSample,		12,						12)							\
+	X(MSG_LINK_REPORT,	MsgLinkReport,	8,						8)							\
+	X(MSG_STAT_REQUEST,	MsgStatRequest,	0,						1)
+
+#define MSG_ENUM_LENGTH(Type, Body, Min, Max)	Type##_MIN = (Min), Type##_LENGTH = (Max),
+enum {MSG_LIST(MSG_ENUM_LENGTH) MSG_LENGTH_END};
+
+/**
+ * @brief 编译期布局检查
+ * @note 条件不成立时数组长度为-1，编译报错；消息体直接按结构体在数据包中读写，不逐字节拷贝，
+ *       因此结构体大小必须与线上长度一致（变长消息末尾最多补齐1字节），且不超过PROTO_MAX_BODY；
+ *       多字节字段按小端直接访问，大端平台无法编译
+ */
+#define MSG_ASSERT(Cond, Name)	typedef char Msg_Assert_##Name[(Cond) ? 1 : -1]
+#define MSG_CHECK_LAYOUT(Type, Body, Min, Max)											\
+	MSG_ASSERT((Min) <= (Max) && (Max) <= PROTO_MAX_BODY &&								\
+	           sizeof(Body) >= (Max) && sizeof(Body) <= (Max) + 1, Type);
+MSG_LIST(MSG_CHECK_LAYOUT)
+
+#if (defined(__CC_ARM) && defined(__BIG_ENDIAN)) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#error "消息体按小端直接访问，不支持大端平台"
+#endif
+
+#endif
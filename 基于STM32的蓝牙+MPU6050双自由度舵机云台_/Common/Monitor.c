@@ -0,0 +1,213 @@
+#include "stm32f10x.h"                  // Device header
+#include <string.h>
+#include "Timer.h"
+#include "Monitor.h"
+#include "Log.h"
+
+/**
+  * @brief  单个任务的耗时统计
+  */
+typedef struct {
+	const char *Name;		//任务名称（报告中显示）
+	uint32_t Budget;		//单次执行预算（us），超出计为一次超时
+	uint32_t Start;			//本次开始时间戳
+	uint32_t Max;			//最长耗时（us）
+	uint32_t Sum;			//累计耗时（us）
+	uint32_t Count;			//执行次数
+	uint32_t Overrun;		//超预算次数
+} MonitorTask;
+
+/**
+  * @brief  抖动直方图桶上界（us），最后一桶收纳其余全部
+  * @note   抖动定义为实际循环周期与标称周期之差的绝对值
+  */
+static const uint32_t Monitor_HistEdge[MONITOR_HIST_NUM - 1] = {50, 100, 200, 500, 1000, 2000, 5000};
+
+static MonitorTask Monitor_Task[MONITOR_TASK_MAX];
+static uint32_t Monitor_Period;			//标称循环周期（us）
+static uint32_t Monitor_LastBegin;		//上一次循环开始时间戳
+static uint8_t Monitor_Valid;			//上一次时间戳有效（复位或输出报告后的第一圈不计入统计）
+
+static uint32_t Monitor_Min;			//最短周期（us）
+static uint32_t Monitor_Max;			//最长周期（us）
+static uint32_t Monitor_Sum;			//累计周期（us），约71分钟内需输出一次报告以免溢出
+static uint32_t Monitor_Count;			//统计的周期数
+static uint32_t Monitor_Overrun;		//周期超过标称值+MONITOR_SLACK_US的次数
+static uint32_t Monitor_Hist[MONITOR_HIST_NUM];
+
+/**
+  * @brief  循环监测初始化
+  * @param  PeriodUs 标称循环周期（us）
+  * @retval 无
+  * @note   需先调用Timer_Init
+  */
+void Monitor_Init(uint32_t PeriodUs)
+{
+	Monitor_Period = PeriodUs;
+	memset(Monitor_Task, 0, sizeof(Monitor_Task));
+	Monitor_Reset();
+}
+
+/**
+  * @brief  登记一个被监测的任务
+  * @param  Task 任务编号，范围：0~MONITOR_TASK_MAX-1
+  * @param  Name 任务名称
+  * @param  BudgetUs 单次执行预算（us）
+  * @retval 无
+  */
+void Monitor_AddTask(uint8_t Task, const char *Name, uint32_t BudgetUs)
+{
+	if (Task >= MONITOR_TASK_MAX) {return;}
+	Monitor_Task[Task].Name = Name;
+	Monitor_Task[Task].Budget = BudgetUs;
+}
+
+/**
+  * @brief  主循环每圈开始时调用，统计循环周期与抖动
+  * @param  无
+  * @retval 无
+  */
+void Monitor_LoopBegin(void)
+{
+	uint32_t Now = Timer_GetMicros();
+	uint32_t Period = Now - Monitor_LastBegin;
+	uint32_t Jitter;
+	uint8_t i;
+	
+	Monitor_LastBegin = Now;
+	if (!Monitor_Valid)
+	{
+		Monitor_Valid = 1;
+		return;
+	}
+	
+	if (Period < Monitor_Min) {Monitor_Min = Period;}
+	if (Period > Monitor_Max) {Monitor_Max = Period;}
+	Monitor_Sum += Period;
+	Monitor_Count++;
+	if (Period > Monitor_Period + MONITOR_SLACK_US) {Monitor_Overrun++;}
+	
+	Jitter = (Period > Monitor_Period) ? (Period - Monitor_Period) : (Monitor_Period - Period);
+	for (i = 0; i < MONITOR_HIST_NUM - 1; i++)
+	{
+		if (Jitter < Monitor_HistEdge[i]) {break;}
+	}
+	Monitor_Hist[i]++;
+}
+
+/**
+  * @brief  任务开始
+  * @param  Task 任务编号
+  * @retval 无
+  */
+void Monitor_TaskBegin(uint8_t Task)
+{
+	if (Task >= MONITOR_TASK_MAX) {return;}
+	Monitor_Task[Task].Start = Timer_GetMicros();
+}
+
+/**
+  * @brief  任务结束，统计耗时并检查是否超出预算
+  * @param  Task 任务编号
+  * @retval 无
+  */
+void Monitor_TaskEnd(uint8_t Task)
+{
+	MonitorTask *T;
+	uint32_t Cost;
+	
+	if (Task >= MONITOR_TASK_MAX) {return;}
+	T = &Monitor_Task[Task];
+	Cost = Timer_GetMicros() - T->Start;
+	
+	if (Cost > T->Max) {T->Max = Cost;}
+	T->Sum += Cost;
+	T->Count++;
+	if (T->Budget != 0 && Cost > T->Budget) {T->Overrun++;}
+}
+
+/**
+  * @brief  清空统计数据，下一圈重新开始计时
+  * @param  无
+  * @retval 无
+  */
+void Monitor_Reset(void)
+{
+	uint8_t i;
+	
+	Monitor_Valid = 0;
+	Monitor_Min = 0xFFFFFFFF;
+	Monitor_Max = 0;
+	Monitor_Sum = 0;
+	Monitor_Count = 0;
+	Monitor_Overrun = 0;
+	memset(Monitor_Hist, 0, sizeof(Monitor_Hist));
+	
+	for (i = 0; i < MONITOR_TASK_MAX; i++)
+	{
+		Monitor_Task[i].Max = 0;
+		Monitor_Task[i].Sum = 0;
+		Monitor_Task[i].Count = 0;
+		Monitor_Task[i].Overrun = 0;
+	}
+}
+
+/**
+  * @brief  输出统计报告，输出后清空统计
+  * @param  无
+  * @retval 无
+  * @note   只写入日志缓冲区（见Log.h），由Telemetry_DrainLog在后台发出；输出后的第一圈不计入统计
+  */
+void Monitor_Report(void)
+{
+	uint8_t i;
+	
+	LOG("LOOP n=%lu min=%lu max=%lu avg=%lu ovr=%lu\r\n",
+		Monitor_Count,
+		Monitor_Count ? Monitor_Min : 0,
+		Monitor_Max,
+		Monitor_Count ? Monitor_Sum / Monitor_Count : 0,
+		Monitor_Overrun);
+	
+	LOG("JIT");
+	for (i = 0; i < MONITOR_HIST_NUM; i++)
+	{
+		if (i < MONITOR_HIST_NUM - 1)
+		{
+			LOG(" <%lu:%lu", Monitor_HistEdge[i], Monitor_Hist[i]);
+		}
+		else
+		{
+			LOG(" >=%lu:%lu", Monitor_HistEdge[i - 1], Monitor_Hist[i]);
+		}
+	}
+	LOG("\r\n");
+	
+	for (i = 0; i < MONITOR_TASK_MAX; i++)
+	{
+		MonitorTask *T = &Monitor_Task[i];
+		if (T->Name == 0) {continue;}
+		LOG("TASK %s n=%lu max=%lu avg=%lu ovr=%lu\r\n",
+			(uint32_t)(uintptr_t)T->Name,
+			T->Count,
+			T->Max,
+			T->Count ? T->Sum / T->Count : 0,
+			T->Overrun);
+	}
+	if (Log_Dropped > 0)
+	{
+		LOG("LOG drop=%lu\r\n", Log_Dropped);
+	}
+	
+	Monitor_Reset();
+}
+
+/**
+  * @brief  上次输出报告以来的最长循环周期
+  * @param  无
+  * @retval 最长周期（us），尚无统计时为0
+  */
+uint32_t Monitor_MaxPeriod(void)
+{
+	return Monitor_Max;
+}
@@ -0,0 +1,17 @@
+#ifndef __MONITOR_H
+#define __MONITOR_H
+
+#define MONITOR_TASK_MAX	6			//最多监测的任务数
+#define MONITOR_HIST_NUM	8			//抖动直方图桶数
+#define MONITOR_SLACK_US	1000		//循环周期超出标称值多少us计为一次超时
+
+void Monitor_Init(uint32_t PeriodUs);
+void Monitor_AddTask(uint8_t Task, const char *Name, uint32_t BudgetUs);
+void Monitor_LoopBegin(void);
+void Monitor_TaskBegin(uint8_t Task);
+void Monitor_TaskEnd(uint8_t Task);
+void Monitor_Reset(void);
+void Monitor_Report(void);
+uint32_t Monitor_MaxPeriod(void);
+
+#endif
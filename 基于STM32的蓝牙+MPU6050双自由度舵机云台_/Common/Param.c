@@ -0,0 +1,95 @@
+#include <string.h>
+#include "Param.h"
+#include "Message.h"
+
+/**
+  * @brief  按编号查找参数
+  * @param  Table 参数表
+  * @param  Id 参数编号
+  * @retval 参数定义，不存在时返回0
+  */
+static const ParamDef *Param_Find(const ParamTable *Table, uint8_t Id)
+{
+	uint8_t i;
+	for (i = 0; i < Table->Count; i ++)
+	{
+		if (Table->Def[i].Id == Id) {return &Table->Def[i];}
+	}
+	return 0;
+}
+
+/**
+  * @brief  处理发给本板的读/写参数消息
+  * @param  Table 本板参数表
+  * @param  Type 消息类型，MSG_PARAM_GET或MSG_PARAM_SET
+  * @param  Body 消息体（MsgParam）
+  * @param  Length 消息体长度
+  * @param  Reply 应答消息体（MsgParamAck）
+  * @retval 应答消息体长度，目标不是本板时返回0
+  * @note   写参数先校验全部编号和范围，再一起写入并做组合校验，组合校验失败则全部恢复原值，
+  *         不会出现只改了一半的参数组；在主循环中调用，控制代码只会看到写入前或写入后的参数；
+  *         应答回读消息中各参数的当前值，出错时状态非0
+  */
+uint8_t Param_Handle(const ParamTable *Table, uint8_t Type, const uint8_t *Body, uint8_t Length, uint8_t *Reply)
+{
+	const ParamDef *Def[PARAM_MAX_ITEMS];
+	float Value[PARAM_MAX_ITEMS];
+	float Old[PARAM_MAX_ITEMS];
+	uint8_t Count = 0;
+	uint8_t Status = PARAM_OK;
+	uint8_t Size, i;
+	
+	if (Length < 1 || Body[0] != Table->Self) {return 0;}
+	
+	Size = Type == MSG_PARAM_SET ? 5 : 1;
+	if ((Length - 1) % Size != 0 || (Length - 1) / Size > PARAM_MAX_ITEMS)
+	{
+		Status = PARAM_ERR_FORMAT;
+	}
+	else
+	{
+		for (i = 1; i < Length; i += Size)
+		{
+			Def[Count] = Param_Find(Table, Body[i]);
+			if (Def[Count] == 0) {Status = PARAM_ERR_ID; break;}
+			if (Size == 5)
+			{
+				memcpy(&Value[Count], &Body[i + 1], 4);
+				if (!(Value[Count] >= Def[Count]->Min && Value[Count] <= Def[Count]->Max))	//NaN也不通过
+				{
+					Status = PARAM_ERR_RANGE;
+					break;
+				}
+			}
+			Count ++;
+		}
+	}
+	
+	if (Status == PARAM_OK && Size == 5)
+	{
+		for (i = 0; i < Count; i ++)
+		{
+			Old[i] = *Def[i]->Value;
+			*Def[i]->Value = Value[i];
+		}
+		if (Table->Check != 0 && !Table->Check())
+		{
+			for (i = Count; i > 0; i --)		//倒序恢复，同一编号出现多次时恢复到最初的值
+			{
+				*Def[i - 1]->Value = Old[i - 1];
+			}
+			Status = PARAM_ERR_CHECK;
+		}
+	}
+	
+	Reply[0] = Table->Self;
+	Reply[1] = Status;
+	Size = 2;
+	for (i = 0; i < Count; i ++)
+	{
+		Reply[Size] = Def[i]->Id;
+		memcpy(&Reply[Size + 1], Def[i]->Value, 4);
+		Size += 5;
+	}
+	return Size;
+}
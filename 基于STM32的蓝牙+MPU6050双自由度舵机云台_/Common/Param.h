@@ -0,0 +1,39 @@
+#ifndef __PARAM_H
+#define __PARAM_H
+
+#include <stdint.h>
+
+#define PARAM_DEST_SENDER	0x01		//发送端（姿态采集）
+#define PARAM_DEST_RECEIVER	0x02		//接收端（舵机控制）
+#define PARAM_MAX_ITEMS		4			//单条消息最多携带的参数个数（受PROTO_MAX_BODY限制）
+#define PARAM_ITEM_BYTES	(5 * PARAM_MAX_ITEMS)	//参数项最大字节数：每项[编号][float]
+
+#define PARAM_OK			0			//成功
+#define PARAM_ERR_FORMAT	1			//消息格式错误
+#define PARAM_ERR_ID		2			//未知参数编号
+#define PARAM_ERR_RANGE		3			//超出该参数的取值范围
+#define PARAM_ERR_CHECK		4			//参数组合不合理（如最小值大于最大值），整条消息未生效
+
+/**
+ * @brief 可调参数定义
+ */
+typedef struct {
+	uint8_t Id;							//参数编号，同一块板内唯一
+	float *Value;						//参数变量
+	float Min;							//允许的最小值
+	float Max;							//允许的最大值
+} ParamDef;
+
+/**
+ * @brief 一块板的参数表
+ */
+typedef struct {
+	uint8_t Self;						//本板地址，PARAM_DEST_SENDER或PARAM_DEST_RECEIVER
+	const ParamDef *Def;				//参数定义数组
+	uint8_t Count;						//参数个数
+	uint8_t (*Check)(void);				//写入后的组合校验，返回0表示不合理；可为0
+} ParamTable;
+
+uint8_t Param_Handle(const ParamTable *Table, uint8_t Type, const uint8_t *Body, uint8_t Length, uint8_t *Reply);
+
+#endif
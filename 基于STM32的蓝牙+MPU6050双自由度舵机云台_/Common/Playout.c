@@ -0,0 +1,294 @@
+#include "Playout.h"
+#include "Latency.h"
+
+/**
+  * @brief  取第Index个样本（0为最早）
+  */
+#define PLAYOUT_AT(Play, Index)		((Play)->Sample[((Play)->Head + (Index)) % PLAYOUT_SIZE])
+
+/**
+  * @brief  抖动缓冲初始化
+  * @param  Play 抖动缓冲
+  * @param  MaxDelay 回放延时上限（us），自适应延时从此值开始向下收敛
+  * @retval 无
+  */
+void Playout_Init(Playout *Play, uint32_t MaxDelay)
+{
+	Play->Head = 0;
+	Play->Count = 0;
+	Play->HasPrev = 0;
+	Play->Anchored = 0;
+	Play->Starved = 0;
+	Play->Adaptive = 1;
+	Play->WinCount = 0;
+	Play->Anchor = 0;
+	Play->Delay = MaxDelay;
+	Play->MaxDelay = MaxDelay;
+	Play->Peak = 0;
+	Play->WinPeak = 0;
+	Play->WinMin = 0xFFFFFFFF;
+	Play->LastStamp = 0;
+	Play->LastTime = 0;
+	Play->Underruns = 0;
+	Play->Late = 0;
+	Play->Resyncs = 0;
+}
+
+/**
+  * @brief  将16位时间戳展开为32位微秒时间
+  * @param  Play 抖动缓冲
+  * @param  Stamp 16位时间戳（Latency_Stamp）
+  * @retval 发送端时间（us）
+  * @note   以最近展开的时间戳为参考，前后约4.2s内的时间戳都能正确展开；
+  *         更久没有样本时展开结果可能偏差一个回绕周期，由Playout_Push重新对齐
+  */
+static uint32_t Playout_Expand(Playout *Play, uint16_t Stamp)
+{
+	uint32_t Time;
+	
+	if (!Play->Anchored)
+	{
+		Time = (uint32_t)Stamp << LATENCY_STAMP_SHIFT;
+	}
+	else
+	{
+		Time = Play->LastTime + (uint32_t)((int32_t)(int16_t)(Stamp - Play->LastStamp) * (1 << LATENCY_STAMP_SHIFT));
+	}
+	if (!Play->Anchored || (int32_t)(Time - Play->LastTime) > 0)
+	{
+		Play->LastStamp = Stamp;
+		Play->LastTime = Time;
+	}
+	return Time;
+}
+
+/**
+  * @brief  清空缓冲区，以当前样本重新对齐回放时刻
+  * @param  Play 抖动缓冲
+  * @param  Time 样本时间（us）
+  * @param  Now 到达时间（us）
+  * @retval 无
+  */
+static void Playout_Resync(Playout *Play, uint32_t Time, uint32_t Now)
+{
+	if (Play->Anchored) {Play->Resyncs ++;}
+	Play->Head = 0;
+	Play->Count = 0;
+	Play->HasPrev = 0;
+	Play->Anchor = Time - Now;
+	Play->Anchored = 1;
+	Play->Peak = 0;
+	Play->WinPeak = 0;
+	Play->WinMin = 0xFFFFFFFF;
+	Play->WinCount = 0;
+}
+
+/**
+  * @brief  由样本的传输时间更新抖动统计和回放延时
+  * @param  Play 抖动缓冲
+  * @param  Time 样本时间（us）
+  * @param  Now 到达时间（us）
+  * @retval 无
+  * @note   传输时间以Anchor为基准：更快的样本立即下调基准；窗口内最小传输时间仍大于0
+  *         说明两端时钟漂移，窗口结束时把基准移过去；峰值每个窗口衰减1/4
+  */
+static void Playout_Track(Playout *Play, uint32_t Time, uint32_t Now)
+{
+	int32_t Transit = (int32_t)(Now + Play->Anchor - Time);
+	uint32_t Target;
+	
+	if (!Play->Anchored || Transit > PLAYOUT_RESYNC || Transit < -PLAYOUT_RESYNC)
+	{
+		Playout_Resync(Play, Time, Now);
+		Transit = 0;
+	}
+	else if (Transit < 0)
+	{
+		Play->Anchor -= Transit;				//更快的样本：回放时刻随之前移，已统计的抖动相应增大
+		Play->Peak -= Transit;
+		Play->WinPeak -= Transit;
+		if (Play->WinMin != 0xFFFFFFFF) {Play->WinMin -= Transit;}
+		Transit = 0;
+	}
+	
+	if ((uint32_t)Transit > Play->Peak) {Play->Peak = Transit;}
+	if ((uint32_t)Transit > Play->WinPeak) {Play->WinPeak = Transit;}
+	if ((uint32_t)Transit < Play->WinMin) {Play->WinMin = Transit;}
+	if (++ Play->WinCount >= PLAYOUT_WINDOW)
+	{
+		Play->Anchor -= Play->WinMin;			//跟随时钟漂移
+		Play->WinPeak -= Play->WinMin;
+		Play->Peak = Play->Peak - (Play->Peak >> 2);
+		if (Play->Peak < Play->WinPeak) {Play->Peak = Play->WinPeak;}
+		Play->WinPeak = 0;
+		Play->WinMin = 0xFFFFFFFF;
+		Play->WinCount = 0;
+	}
+	
+	if (!Play->Adaptive)
+	{
+		Play->Delay = Play->MaxDelay;
+		return;
+	}
+	Target = Play->Peak + PLAYOUT_GUARD;
+	if (Target > Play->MaxDelay) {Target = Play->MaxDelay;}
+	if (Target > Play->Delay)
+	{
+		Play->Delay = Target;					//抖动变大：立即增大延时，避免欠载
+	}
+	else
+	{
+		Play->Delay -= (Play->Delay - Target) >> 4;	//抖动变小：缓慢减小，避免回放跳跃
+	}
+}
+
+/**
+  * @brief  加入一个样本
+  * @param  Play 抖动缓冲
+  * @param  Stamp 发送端采样时间戳
+  * @param  Now 样本的到达时间（us，本地时钟）
+  * @param  Angle1 角度1
+  * @param  Angle2 角度2
+  * @retval 1表示样本进入缓冲区，0表示被丢弃（迟到、重复或比缓冲区中所有样本都早）
+  * @note   按时间戳排序插入，乱序到达的样本放回原位，重复样本丢弃；到达时已过回放时刻的样本
+  *         只用于抖动统计（使延时增大）后丢弃；缓冲区满时丢弃最早的样本
+  */
+uint8_t Playout_Push(Playout *Play, uint16_t Stamp, uint32_t Now, float Angle1, float Angle2)
+{
+	uint32_t Time = Playout_Expand(Play, Stamp);
+	uint8_t i, j;
+	
+	Playout_Track(Play, Time, Now);
+	
+	if (Play->Count > 0 && (int32_t)(Time - (Now + Play->Anchor - Play->Delay)) <= 0)
+	{
+		Play->Late ++;
+		return 0;
+	}
+	
+	//从最新样本往前找插入位置
+	i = Play->Count;
+	while (i > 0 && (int32_t)(PLAYOUT_AT(Play, i - 1).Time - Time) > 0) {i --;}
+	if (i > 0 && PLAYOUT_AT(Play, i - 1).Time == Time) {return 0;}
+	
+	if (Play->Count == PLAYOUT_SIZE)
+	{
+		if (i == 0) {return 0;}					//比缓冲区中所有样本都早
+		Play->Prev = PLAYOUT_AT(Play, 0);
+		Play->HasPrev = 1;
+		Play->Head = (Play->Head + 1) % PLAYOUT_SIZE;
+		Play->Count --;
+		i --;
+	}
+	Play->Count ++;
+	for (j = Play->Count - 1; j > i; j --)
+	{
+		PLAYOUT_AT(Play, j) = PLAYOUT_AT(Play, j - 1);
+	}
+	PLAYOUT_AT(Play, i).Time = Time;
+	PLAYOUT_AT(Play, i).Angle1 = Angle1;
+	PLAYOUT_AT(Play, i).Angle2 = Angle2;
+	Play->Starved = 0;
+	return 1;
+}
+
+/**
+  * @brief  三次Hermite插值
+  * @param  P1 区间起点的值
+  * @param  P2 区间终点的值
+  * @param  M1 起点切线（已乘区间长度）
+  * @param  M2 终点切线（已乘区间长度）
+  * @param  S 区间内的位置，范围：0~1
+  * @retval 插值结果
+  */
+static float Playout_Hermite(float P1, float P2, float M1, float M2, float S)
+{
+	float S2 = S * S;
+	float S3 = S2 * S;
+	
+	return (2 * S3 - 3 * S2 + 1) * P1 + (S3 - 2 * S2 + S) * M1 + (-2 * S3 + 3 * S2) * P2 + (S3 - S2) * M2;
+}
+
+/**
+  * @brief  取当前回放时刻的角度
+  * @param  Play 抖动缓冲
+  * @param  Now 当前时间（us，本地时钟）
+  * @param  Mode PLAYOUT_LINEAR或PLAYOUT_HERMITE
+  * @param  Angle1 输出角度1
+  * @param  Angle2 输出角度2
+  * @retval 1表示有输出，0表示还没有到达第一个样本的回放时刻
+  * @note   每次舵机控制前调用；Hermite切线取相邻样本的差商（Catmull-Rom），
+  *         区间两端缺少相邻样本时退化为区间自身的斜率
+  */
+uint8_t Playout_Get(Playout *Play, uint32_t Now, uint8_t Mode, float *Angle1, float *Angle2)
+{
+	uint32_t Time;
+	const PlayoutSample *P0, *P1, *P2, *P3;
+	float S, Span, K1, K2;
+	uint32_t Start;
+	
+	if (Play->Count == 0) {return 0;}
+	Time = Now + Play->Anchor - Play->Delay;
+	
+	//移出回放时刻之前的样本，保留区间起点
+	while (Play->Count >= 2 && (int32_t)(Time - PLAYOUT_AT(Play, 1).Time) >= 0)
+	{
+		Play->Prev = PLAYOUT_AT(Play, 0);
+		Play->HasPrev = 1;
+		Play->Head = (Play->Head + 1) % PLAYOUT_SIZE;
+		Play->Count --;
+	}
+	
+	P1 = &PLAYOUT_AT(Play, 0);
+	if ((int32_t)(Time - P1->Time) < 0)
+	{
+		if (!Play->HasPrev) {return 0;}		//第一个样本还未到回放时刻
+		P2 = P1;							//Prev与P1之间
+		P1 = &Play->Prev;
+		P0 = 0;
+		P3 = Play->Count >= 2 ? &PLAYOUT_AT(Play, 1) : 0;
+	}
+	else if (Play->Count == 1)
+	{
+		*Angle1 = P1->Angle1;				//回放追上最新样本：保持
+		*Angle2 = P1->Angle2;
+		if (!Play->Starved && Play->HasPrev)
+		{
+			Play->Underruns ++;
+			Play->Starved = 1;
+		}
+		return 1;
+	}
+	else
+	{
+		P2 = &PLAYOUT_AT(Play, 1);
+		P0 = Play->HasPrev ? &Play->Prev : 0;
+		P3 = Play->Count >= 3 ? &PLAYOUT_AT(Play, 2) : 0;
+	}
+	
+	//发送端静止时不发送，区间过长说明P1是静止期间的旧样本，过渡只取区间末尾一段
+	Start = P1->Time;
+	if (P2->Time - Start > PLAYOUT_MAX_GAP) {Start = P2->Time - PLAYOUT_MAX_GAP;}
+	Span = (float)(P2->Time - Start);
+	S = (float)(int32_t)(Time - Start) / Span;
+	if (S < 0) {S = 0;}
+	if (S > 1) {S = 1;}
+	
+	if (Mode != PLAYOUT_HERMITE)
+	{
+		*Angle1 = P1->Angle1 + (P2->Angle1 - P1->Angle1) * S;
+		*Angle2 = P1->Angle2 + (P2->Angle2 - P1->Angle2) * S;
+		return 1;
+	}
+	
+	//切线按区间长度归一化：M = 斜率 * Span
+	K1 = P0 ? Span / (float)(P2->Time - P0->Time) : 1.0f;
+	K2 = P3 ? Span / (float)(P3->Time - Start) : 1.0f;
+	*Angle1 = Playout_Hermite(P1->Angle1, P2->Angle1,
+	                          ((P0 ? P2->Angle1 - P0->Angle1 : P2->Angle1 - P1->Angle1)) * K1,
+	                          ((P3 ? P3->Angle1 - P1->Angle1 : P2->Angle1 - P1->Angle1)) * K2, S);
+	*Angle2 = Playout_Hermite(P1->Angle2, P2->Angle2,
+	                          ((P0 ? P2->Angle2 - P0->Angle2 : P2->Angle2 - P1->Angle2)) * K1,
+	                          ((P3 ? P3->Angle2 - P1->Angle2 : P2->Angle2 - P1->Angle2)) * K2, S);
+	return 1;
+}
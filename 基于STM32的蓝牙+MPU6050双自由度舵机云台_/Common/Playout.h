@@ -0,0 +1,59 @@
+#ifndef __PLAYOUT_H
+#define __PLAYOUT_H
+
+#include <stdint.h>
+
+#define PLAYOUT_SIZE		12			//缓存的样本数，需容纳最大回放延时内的样本
+#define PLAYOUT_OFF			0			//不插值，收到即用
+#define PLAYOUT_LINEAR		1			//线性插值
+#define PLAYOUT_HERMITE		2			//三次Hermite插值（Catmull-Rom切线）
+#define PLAYOUT_MAX_GAP		20000		//插值区间最长（us），静止后恢复运动时不把整段静止时间当作过渡
+#define PLAYOUT_GUARD		2000		//自适应延时在抖动峰值之上的余量（us）
+#define PLAYOUT_WINDOW		64			//抖动统计窗口（样本数），窗口结束时峰值衰减、基准跟随时钟漂移
+#define PLAYOUT_RESYNC		1000000		//传输时间偏离基准超过此值（us）时清空缓冲区重新对齐
+
+/**
+ * @brief 带时间戳的角度样本
+ */
+typedef struct {
+	uint32_t Time;						//发送端采样时间（us，由16位时间戳展开）
+	float Angle1;						//角度1（度）
+	float Angle2;						//角度2（度）
+} PlayoutSample;
+
+/**
+ * @brief 抖动缓冲与回放（接收端）
+ * @note 样本按发送端时间戳排序插入，以延时Delay回放：回放时刻 = 本地时间 + Anchor - Delay；
+ *       Anchor取传输最快的样本的"样本时间 - 到达时间"，其他样本相对它的额外传输时间即抖动；
+ *       自适应时Delay跟随抖动峰值加PLAYOUT_GUARD，需要时立即增大、平时缓慢减小，不超过MaxDelay；
+ *       回放时刻落在两个样本之间时插值，超过最新样本时保持最新值并计为一次欠载，
+ *       到达时已过回放时刻的样本丢弃并计为迟到
+ */
+typedef struct {
+	PlayoutSample Sample[PLAYOUT_SIZE];	//环形缓冲区，按时间升序
+	uint8_t Head;						//最早样本的位置
+	uint8_t Count;						//样本数（缓冲深度）
+	uint8_t HasPrev;					//Prev有效
+	PlayoutSample Prev;					//最近移出的样本，作为区间起点或Hermite切线的参考
+	uint8_t Anchored;					//Anchor有效
+	uint8_t Starved;					//已计入本次欠载
+	uint8_t Adaptive;					//1：自适应延时，0：固定为MaxDelay
+	uint8_t WinCount;					//当前窗口已统计的样本数
+	uint32_t Anchor;					//发送端时间 - 本地时间（us，按2^32取模）
+	uint32_t Delay;						//当前回放延时（us）
+	uint32_t MaxDelay;					//延时上限；非自适应时即固定延时（us）
+	uint32_t Peak;						//抖动峰值（us）
+	uint32_t WinPeak;					//当前窗口的抖动峰值（us）
+	uint32_t WinMin;					//当前窗口的最小传输时间（us，相对Anchor）
+	uint16_t LastStamp;					//最近展开的16位时间戳
+	uint32_t LastTime;					//LastStamp展开后的时间（us）
+	uint32_t Underruns;					//欠载次数：回放追上最新样本
+	uint32_t Late;						//迟到丢弃的样本数
+	uint32_t Resyncs;					//重新对齐次数
+} Playout;
+
+void Playout_Init(Playout *Play, uint32_t MaxDelay);
+uint8_t Playout_Push(Playout *Play, uint16_t Stamp, uint32_t Now, float Angle1, float Angle2);
+uint8_t Playout_Get(Playout *Play, uint32_t Now, uint8_t Mode, float *Angle1, float *Angle2);
+
+#endif
@@ -0,0 +1,179 @@
+#include <string.h>
+#include "Proto.h"
+
+/**
+ * @brief 消息体未对齐时的对齐副本
+ */
+static uint32_t Proto_Scratch[(PROTO_MAX_BODY + 3) / 4];
+
+/**
+ * @brief 本节点地址，上电为发送端的设置，接收端由Proto_SetAddress修改
+ */
+static uint8_t Proto_Self = PROTO_ADDR_HOST;		//本节点编号
+static uint8_t Proto_Groups = 0;					//加入的组（按位）
+static uint8_t Proto_Dest = PROTO_ADDR_BROADCAST;	//Proto_Begin使用的默认目标
+static uint8_t Proto_From = PROTO_ADDR_HOST;		//正在分发的数据包的来源
+
+/**
+  * @brief  设置本节点地址
+  * @param  Self 本节点编号，PROTO_ADDR_HOST或1~PROTO_ADDR_NODE_MAX
+  * @param  Groups 加入的组，第g位为1表示接收PROTO_ADDR_GROUP(g)
+  * @param  Dest 默认目标地址
+  * @retval 无
+  */
+void Proto_SetAddress(uint8_t Self, uint8_t Groups, uint8_t Dest)
+{
+	Proto_Self = Self;
+	Proto_Groups = Groups;
+	Proto_Dest = Dest;
+}
+
+/**
+  * @brief  正在分发的数据包的来源地址
+  * @param  无
+  * @retval 来源地址
+  * @note   只在处理函数中有效，用于把应答发回请求方
+  */
+uint8_t Proto_Source(void)
+{
+	return Proto_From;
+}
+
+/**
+  * @brief  判断数据包是否发给本节点
+  * @param  Dest 目标地址
+  * @retval 1表示接收，0表示丢弃
+  */
+static uint8_t Proto_Match(uint8_t Dest)
+{
+	if (Dest == Proto_Self || Dest == PROTO_ADDR_BROADCAST) {return 1;}
+	if (Dest >= PROTO_ADDR_GROUP(0) && Dest < PROTO_ADDR_GROUP(PROTO_GROUPS))
+	{
+		return (Proto_Groups >> (Dest - PROTO_ADDR_GROUP(0))) & 1;
+	}
+	return 0;
+}
+
+/**
+  * @brief  开始组装发给默认目标的数据包
+  * @param  Packet 数据包缓冲区
+  * @retval 当前长度
+  */
+uint8_t Proto_Begin(uint8_t *Packet)
+{
+	return Proto_BeginTo(Packet, Proto_Dest);
+}
+
+/**
+  * @brief  开始组装发给指定目标的数据包
+  * @param  Packet 数据包缓冲区
+  * @param  Dest 目标地址
+  * @retval 当前长度
+  * @note   数据包格式：[版本][目标][来源]{[类型][长度][消息体]}...，一个数据包可携带多条消息，
+  *         同一数据包内的消息目标相同
+  */
+uint8_t Proto_BeginTo(uint8_t *Packet, uint8_t Dest)
+{
+	Packet[0] = PROTO_VERSION;
+	Packet[1] = Dest;
+	Packet[2] = Proto_Self;
+	return 3;
+}
+
+/**
+  * @brief  向数据包追加一条消息
+  * @param  Packet 数据包缓冲区，至少LINK_MAX_DATA字节
+  * @param  Length 当前长度
+  * @param  Type 消息类型
+  * @param  Body 消息体
+  * @param  BodyLength 消息体长度
+  * @retval 追加后的长度
+  */
+uint8_t Proto_Add(uint8_t *Packet, uint8_t Length, uint8_t Type, const void *Body, uint8_t BodyLength)
+{
+	Packet[Length] = Type;
+	Packet[Length + 1] = BodyLength;
+	memcpy(&Packet[Length + 2], Body, BodyLength);
+	return Length + 2 + BodyLength;
+}
+
+/**
+  * @brief  解析数据包并按分发表调用处理函数
+  * @param  Table 分发表
+  * @param  Count 表项数
+  * @param  Stats 解析统计
+  * @param  Packet 数据包
+  * @param  Length 数据包长度
+  * @param  Time 数据包接收时间（us）
+  * @retval 处理的消息数
+  * @note   主版本不同的数据包整包丢弃；目标不是本节点（编号、所在组或广播）的数据包在解析
+  *         任何消息之前丢弃；次版本不同时照常解析，本端不认识的消息按长度跳过，
+  *         新增消息类型不影响已部署的旧版本；消息体4字节对齐时直接传入原数据（零拷贝），
+  *         否则先复制到对齐的缓冲区
+  */
+uint8_t Proto_Dispatch(const ProtoEntry *Table, uint8_t Count, ProtoStats *Stats,
+                       const uint8_t *Packet, uint8_t Length, uint32_t Time)
+{
+	uint8_t Offset = 3;
+	uint8_t Handled = 0;
+	uint8_t Type, BodyLength, i;
+	const void *Body;
+	
+	if (Length < 1)
+	{
+		Stats->Malformed ++;				//空包没有版本号可比较
+		return 0;
+	}
+	if (PROTO_MAJOR(Packet[0]) != PROTO_MAJOR(PROTO_VERSION))
+	{
+		Stats->Version ++;
+		return 0;
+	}
+	if (Length < 3)
+	{
+		Stats->Malformed ++;
+		return 0;
+	}
+	if (!Proto_Match(Packet[1]))
+	{
+		Stats->Filtered ++;
+		return 0;
+	}
+	Proto_From = Packet[2];
+	
+	while (Offset < Length)
+	{
+		if (Length - Offset < 2 || Length - Offset - 2 < Packet[Offset + 1])
+		{
+			Stats->Malformed ++;				//长度越界，丢弃剩余部分
+			break;
+		}
+		Type = Packet[Offset];
+		BodyLength = Packet[Offset + 1];
+		Body = &Packet[Offset + 2];
+		Offset += 2 + BodyLength;
+		
+		for (i = 0; i < Count; i ++)
+		{
+			if (Table[i].Type == Type) {break;}
+		}
+		if (i == Count)
+		{
+			Stats->Unknown ++;
+			continue;
+		}
+		if (BodyLength < Table[i].MinLength || BodyLength > PROTO_MAX_BODY)
+		{
+			Stats->Malformed ++;
+			continue;
+		}
+		if (((uintptr_t)Body & 3) != 0)
+		{
+			memcpy(Proto_Scratch, Body, BodyLength);
+			Body = Proto_Scratch;
+		}
+		Table[i].Handler(Type, Body, BodyLength, Time);
+		Handled ++;
+	}
+	return Handled;
+}
@@ -0,0 +1,58 @@
+#ifndef __PROTO_H
+#define __PROTO_H
+
+#include <stdint.h>
+
+#define PROTO_VERSION		0x20		//协议版本：高4位为主版本，低4位为次版本
+#define PROTO_MAJOR(v)		((v) >> 4)
+#define PROTO_HEADER		5			//数据包头[版本][目标][来源]与第一个TLV头[类型][长度]的字节数
+#define PROTO_MAX_BODY		24			//单个消息体最大长度：LINK_MAX_DATA减去PROTO_HEADER
+
+/**
+ * @brief 节点地址
+ * @note 发送端（手柄）为PROTO_ADDR_HOST，各接收端（云台）为1~PROTO_ADDR_NODE_MAX；
+ *       组地址发给所有加入该组的接收端，广播地址发给所有节点，其余地址保留
+ */
+#define PROTO_ADDR_HOST		0x00		//发送端
+#define PROTO_ADDR_NODE_MAX	0x7F		//接收端最大编号
+#define PROTO_ADDR_GROUP(g)	(0x80 + (g))	//组地址，g：0~PROTO_GROUPS-1
+#define PROTO_GROUPS		8			//组数，接收端以8位掩码表示加入的组
+#define PROTO_ADDR_BROADCAST	0xFF	//广播
+
+/**
+ * @brief 消息处理函数
+ * @param Type 消息类型
+ * @param Body 消息体，4字节对齐
+ * @param Length 消息体长度，不小于登记的最小长度
+ * @param Time 数据包接收时间（us）
+ */
+typedef void (*ProtoHandler)(uint8_t Type, const void *Body, uint8_t Length, uint32_t Time);
+
+/**
+ * @brief 分发表项
+ */
+typedef struct {
+	uint8_t Type;						//消息类型
+	uint8_t MinLength;					//消息体最小长度，更短的视为格式错误
+	ProtoHandler Handler;				//处理函数
+} ProtoEntry;
+
+/**
+ * @brief 解析统计
+ */
+typedef struct {
+	uint32_t Version;					//主版本不符而丢弃的数据包数
+	uint32_t Unknown;					//本端不认识而跳过的消息数
+	uint32_t Malformed;					//长度错误的数据包或消息数
+	uint32_t Filtered;					//目标不是本节点而丢弃的数据包数
+} ProtoStats;
+
+void Proto_SetAddress(uint8_t Self, uint8_t Groups, uint8_t Dest);
+uint8_t Proto_Source(void);
+uint8_t Proto_Begin(uint8_t *Packet);
+uint8_t Proto_BeginTo(uint8_t *Packet, uint8_t Dest);
+uint8_t Proto_Add(uint8_t *Packet, uint8_t Length, uint8_t Type, const void *Body, uint8_t BodyLength);
+uint8_t Proto_Dispatch(const ProtoEntry *Table, uint8_t Count, ProtoStats *Stats,
+                       const uint8_t *Packet, uint8_t Length, uint32_t Time);
+
+#endif
@@ -0,0 +1,127 @@
+#include <math.h>
+#include "QuatCodec.h"
+
+#define QUAT_SMALL_MAX		0.70710678f	//小分量的绝对值不超过1/√2
+#define QUAT_COMPONENT_MAX	((1UL << QUAT_COMPONENT_BITS) - 1)
+
+/**
+  * @brief  由重力方向计算姿态四元数
+  * @param  Gx、Gy、Gz 机体坐标系下的重力方向（加速度计读数，任意比例）
+  * @param  Q 输出的单位四元数
+  * @retval 1表示成功，0表示读数过小（自由落体或传感器故障），Q不变
+  * @note   取把竖直方向(0,0,1)转到重力方向的最短旋转：Q ∝ [1 + g·z, z × g]，Z分量恒为0；
+  *         完全倒置时旋转轴不唯一，取绕X轴翻转
+  */
+uint8_t QuatCodec_FromGravity(float Gx, float Gy, float Gz, Quat Q)
+{
+	float Norm = sqrtf(Gx * Gx + Gy * Gy + Gz * Gz);
+	float W;
+	
+	if (Norm < 0.1f) {return 0;}
+	Gx /= Norm;
+	Gy /= Norm;
+	Gz /= Norm;
+	
+	W = 1.0f + Gz;
+	if (W < 1e-6f)
+	{
+		Q[0] = 0.0f; Q[1] = 1.0f; Q[2] = 0.0f; Q[3] = 0.0f;
+		return 1;
+	}
+	Norm = sqrtf(2.0f * W);				//|[1 + gz, -gy, gx, 0]|² = 2(1 + gz)
+	Q[0] = W / Norm;
+	Q[1] = -Gy / Norm;
+	Q[2] = Gx / Norm;
+	Q[3] = 0.0f;
+	return 1;
+}
+
+/**
+  * @brief  由姿态四元数还原重力方向
+  * @param  Q 单位四元数
+  * @param  Gx、Gy、Gz 输出的单位重力方向
+  * @retval 无
+  * @note   即用Q旋转竖直方向(0,0,1)
+  */
+void QuatCodec_ToGravity(const Quat Q, float *Gx, float *Gy, float *Gz)
+{
+	*Gx = 2.0f * (Q[1] * Q[3] + Q[0] * Q[2]);
+	*Gy = 2.0f * (Q[2] * Q[3] - Q[0] * Q[1]);
+	*Gz = 1.0f - 2.0f * (Q[1] * Q[1] + Q[2] * Q[2]);
+}
+
+/**
+  * @brief  两个四元数的点积
+  * @param  A、B 单位四元数
+  * @retval 点积，绝对值为两姿态间转角一半的余弦
+  */
+float QuatCodec_Dot(const Quat A, const Quat B)
+{
+	return A[0] * B[0] + A[1] * B[1] + A[2] * B[2] + A[3] * B[3];
+}
+
+/**
+  * @brief  压缩四元数（最小三分量法）
+  * @param  Q 单位四元数
+  * @param  Out 输出缓冲区，QUAT_PACKED_LENGTH字节
+  * @retval 无
+  * @note   Q与-Q表示同一姿态，取绝对值最大的分量为正，由其余三个分量即可还原；
+  *         其余分量的绝对值不超过1/√2，各量化为15位，分辨率约0.005°；
+  *         格式（小端48位）：[1:0]最大分量的序号 [16:2]、[31:17]、[46:32]其余三个分量按序号顺序
+  */
+void QuatCodec_Pack(const Quat Q, uint8_t *Out)
+{
+	uint32_t Small[3];
+	uint32_t Low;
+	uint8_t Largest = 0;
+	uint8_t i, n = 0;
+	float Sign, Value;
+	
+	for (i = 1; i < 4; i ++)
+	{
+		if (fabsf(Q[i]) > fabsf(Q[Largest])) {Largest = i;}
+	}
+	Sign = (Q[Largest] < 0) ? -1.0f : 1.0f;
+	for (i = 0; i < 4; i ++)
+	{
+		if (i == Largest) {continue;}
+		Value = Sign * Q[i];
+		if (Value > QUAT_SMALL_MAX) {Value = QUAT_SMALL_MAX;}
+		if (Value < -QUAT_SMALL_MAX) {Value = -QUAT_SMALL_MAX;}
+		Small[n ++] = (uint32_t)((Value + QUAT_SMALL_MAX) * (QUAT_COMPONENT_MAX / (2.0f * QUAT_SMALL_MAX)) + 0.5f);
+	}
+	
+	Low = Largest | (Small[0] << 2) | (Small[1] << 17);
+	Out[0] = (uint8_t)Low;
+	Out[1] = (uint8_t)(Low >> 8);
+	Out[2] = (uint8_t)(Low >> 16);
+	Out[3] = (uint8_t)(Low >> 24);
+	Out[4] = (uint8_t)Small[2];
+	Out[5] = (uint8_t)(Small[2] >> 8);
+}
+
+/**
+  * @brief  还原压缩的四元数
+  * @param  Data QUAT_PACKED_LENGTH字节的压缩数据
+  * @param  Q 输出的单位四元数
+  * @retval 无
+  */
+void QuatCodec_Unpack(const uint8_t *Data, Quat Q)
+{
+	uint32_t Low = Data[0] | ((uint32_t)Data[1] << 8) | ((uint32_t)Data[2] << 16) | ((uint32_t)Data[3] << 24);
+	uint32_t Small[3];
+	uint8_t Largest = (uint8_t)(Low & 3);
+	uint8_t i, n = 0;
+	float Sum = 0.0f;
+	
+	Small[0] = (Low >> 2) & QUAT_COMPONENT_MAX;
+	Small[1] = (Low >> 17) & QUAT_COMPONENT_MAX;
+	Small[2] = (Data[4] | ((uint32_t)Data[5] << 8)) & QUAT_COMPONENT_MAX;
+	for (i = 0; i < 4; i ++)
+	{
+		if (i == Largest) {continue;}
+		Q[i] = (float)Small[n ++] * (2.0f * QUAT_SMALL_MAX / QUAT_COMPONENT_MAX) - QUAT_SMALL_MAX;
+		Sum += Q[i] * Q[i];
+	}
+	Q[Largest] = (Sum < 1.0f) ? sqrtf(1.0f - Sum) : 0.0f;
+}
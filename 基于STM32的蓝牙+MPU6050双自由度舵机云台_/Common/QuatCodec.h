@@ -0,0 +1,21 @@
+#ifndef __QUAT_CODEC_H
+#define __QUAT_CODEC_H
+
+#include <stdint.h>
+
+#define QUAT_PACKED_LENGTH	6			//压缩后的四元数长度
+#define QUAT_COMPONENT_BITS	15			//每个小分量的位数
+
+/**
+ * @brief 姿态四元数 [W, X, Y, Z]，单位四元数
+ * @note 加速度计只能测出重力方向（倾斜），绕竖直轴的转角不可观测，由重力方向得到的四元数Z分量恒为0
+ */
+typedef float Quat[4];
+
+uint8_t QuatCodec_FromGravity(float Gx, float Gy, float Gz, Quat Q);
+void QuatCodec_ToGravity(const Quat Q, float *Gx, float *Gy, float *Gz);
+float QuatCodec_Dot(const Quat A, const Quat B);
+void QuatCodec_Pack(const Quat Q, uint8_t *Out);
+void QuatCodec_Unpack(const uint8_t *Data, Quat Q);
+
+#endif
@@ -0,0 +1,197 @@
+#include "Rate.h"
+
+/**
+  * @brief  减速原因的名称，按RATE_REASON_*编号，供日志输出
+  */
+const char *const Rate_ReasonText[] = {"none", "loss", "crc", "ovf", "blk", "silent"};
+
+/**
+  * @brief  自适应发送速率初始化
+  * @param  R 自适应发送速率
+  * @param  Max 最高速率（包/秒），即主循环频率
+  * @retval 无
+  */
+void Rate_Init(Rate *R, uint16_t Max)
+{
+	uint8_t i;
+	
+	for (i = 0; i < RATE_NODES; i ++)
+	{
+		R->Node[i].Valid = 0;
+	}
+	R->Max = Max;
+	R->Rate = Max;
+	R->Active = 0;
+	R->Reason = RATE_REASON_NONE;
+	R->Loss = 0;
+	R->Tokens = RATE_TOKEN;
+	R->Last = 0;
+	R->LastReport = 0;
+	R->LastDecrease = 0;
+	R->Blocked = 0;
+	R->Paced = 0;
+	R->Decreases = 0;
+}
+
+/**
+  * @brief  速率减半（乘性减）
+  * @param  R 自适应发送速率
+  * @param  Reason 减速原因
+  * @param  Now 当前时间（us）
+  * @retval 无
+  */
+static void Rate_Decrease(Rate *R, uint8_t Reason, uint32_t Now)
+{
+	R->Rate /= 2;
+	if (R->Rate < RATE_MIN) {R->Rate = RATE_MIN;}
+	R->Reason = Reason;
+	R->LastDecrease = Now;
+	R->Decreases ++;
+}
+
+/**
+  * @brief  收到接收端的链路报告（发送端调用）
+  * @param  R 自适应发送速率
+  * @param  Node 接收端地址
+  * @param  Report LINK_REPORT消息体
+  * @param  Blocked 本端流控的累计推迟次数（Flow.Blocked），两次报告之间有增加说明数据在链路中排队
+  * @param  Now 接收时间（us）
+  * @retval 无
+  * @note   报告为累计计数，按与上次报告的差值计算本周期的丢包率，报告丢失只会使周期变长；
+  *         新的接收端占用空闲或已超时的表项，表满时忽略
+  */
+void Rate_OnReport(Rate *R, uint8_t Node, const MsgLinkReport *Report, uint32_t Blocked, uint32_t Now)
+{
+	RateNode *Slot = 0;
+	uint16_t Received, Lost, CrcErrors, Overflow;
+	uint32_t Total;
+	uint8_t Queued, Reason, i;
+	
+	for (i = 0; i < RATE_NODES; i ++)
+	{
+		if (R->Node[i].Valid && R->Node[i].Node == Node)
+		{
+			Slot = &R->Node[i];
+			break;
+		}
+		if (Slot == 0 && (!R->Node[i].Valid || Now - R->Node[i].Time >= RATE_TIMEOUT))
+		{
+			Slot = &R->Node[i];
+		}
+	}
+	if (Slot == 0) {return;}
+	
+	R->Active = 1;
+	R->LastReport = Now;
+	if (!Slot->Valid || Slot->Node != Node || Now - Slot->Time >= RATE_TIMEOUT)
+	{
+		Slot->Valid = 1;					//新的接收端或中断后恢复：只记录基准
+		Slot->Node = Node;
+		Slot->Last = *Report;
+		Slot->Time = Now;
+		return;
+	}
+	
+	Received = (uint16_t)(Report->Received - Slot->Last.Received);
+	Lost = (uint16_t)(Report->Lost - Slot->Last.Lost);
+	CrcErrors = (uint16_t)(Report->CrcErrors - Slot->Last.CrcErrors);
+	Overflow = (uint16_t)(Report->Overflow - Slot->Last.Overflow);
+	Slot->Last = *Report;
+	Slot->Time = Now;
+	
+	Total = (uint32_t)Received + Lost;
+	R->Loss = Total ? (uint16_t)((uint32_t)Lost * 1000 / Total) : 0;
+	Queued = Blocked != R->Blocked;
+	R->Blocked = Blocked;
+	
+	if (Overflow > 0) {Reason = RATE_REASON_OVERFLOW;}
+	else if (R->Loss > RATE_LOSS_HIGH) {Reason = (CrcErrors * 2 >= Lost) ? RATE_REASON_CRC : RATE_REASON_LOSS;}
+	else if (Queued) {Reason = RATE_REASON_BLOCKED;}
+	else {Reason = RATE_REASON_NONE;}
+	
+	if (Now - R->LastDecrease < RATE_HOLDOFF) {return;}	//上次减速的效果尚未反映到报告中
+	if (Reason != RATE_REASON_NONE)
+	{
+		Rate_Decrease(R, Reason, Now);
+	}
+	else if (R->Loss < RATE_LOSS_LOW && R->Rate < R->Max)
+	{
+		R->Rate += RATE_STEP;
+		if (R->Rate > R->Max) {R->Rate = R->Max;}
+	}
+}
+
+/**
+  * @brief  判断当前速率下是否可以发出新的数据包（发送端调用）
+  * @param  R 自适应发送速率
+  * @param  Now 当前时间（us）
+  * @retval 1表示可以发送（已扣除一个包的令牌），0表示推迟
+  * @note   在确定要发送后调用，推迟时下一周期按届时最新的姿态重新判断；
+  *         满速时不限速，主循环周期的抖动不会造成漏发；收不到报告时每RATE_TIMEOUT减速一次
+  */
+uint8_t Rate_Ready(Rate *R, uint32_t Now)
+{
+	uint32_t Elapsed;
+	
+	if (!R->Active) {return 1;}
+	if (Now - R->LastReport >= RATE_TIMEOUT)
+	{
+		R->LastReport = Now;
+		Rate_Decrease(R, RATE_REASON_SILENT, Now);
+	}
+	
+	Elapsed = Now - R->Last;
+	R->Last = Now;
+	if (R->Rate >= R->Max)
+	{
+		R->Tokens = RATE_TOKEN;
+		return 1;
+	}
+	if (Elapsed > 1000000) {Elapsed = 1000000;}
+	R->Tokens += Elapsed * R->Rate;
+	if (R->Tokens > RATE_TOKEN) {R->Tokens = RATE_TOKEN;}	//最多积攒一个包
+	if (R->Tokens < RATE_TOKEN)
+	{
+		R->Paced ++;
+		return 0;
+	}
+	R->Tokens -= RATE_TOKEN;
+	return 1;
+}
+
+/**
+  * @brief  当前速率下每条消息应携带的样本数
+  * @param  R 自适应发送速率
+  * @param  Limit 样本数上限（1~MSG_BATCH_MAX）
+  * @retval 样本数，满速时为1，减速后为覆盖主循环频率所需的样本数，不超过Limit
+  * @note   减速后把连续几个主循环的样本合在一条消息中，以较少的数据包保留更多运动细节；
+  *         Limit为1时只降低发送频率，每个数据包都是最新的姿态
+  */
+uint8_t Rate_Density(const Rate *R, uint8_t Limit)
+{
+	uint16_t Density = (R->Max + R->Rate - 1) / R->Rate;
+	
+	return (Density > Limit) ? Limit : (uint8_t)Density;
+}
+
+/**
+  * @brief  需要时生成链路报告（接收端调用）
+  * @param  Adv 链路报告状态
+  * @param  Stats 链路接收统计
+  * @param  Overflow 本端串口溢出与接收缓冲区、接收队列溢出的累计次数
+  * @param  Now 当前时间（us）
+  * @param  Report 输出的LINK_REPORT消息体
+  * @retval 1表示需要发送，0表示本次无需发送
+  * @note   每RATE_REPORT_INTERVAL报告一次累计计数的低16位，尚未收到有效数据包时不报告
+  */
+uint8_t Rate_MakeReport(RateAdvert *Adv, const LinkStats *Stats, uint32_t Overflow, uint32_t Now, MsgLinkReport *Report)
+{
+	if (!Stats->Synced || Now - Adv->Time < RATE_REPORT_INTERVAL) {return 0;}
+	
+	Adv->Time = Now;
+	Report->Received = (uint16_t)Stats->Received;
+	Report->Lost = (uint16_t)Stats->Lost;
+	Report->CrcErrors = (uint16_t)Stats->CrcErrors;
+	Report->Overflow = (uint16_t)Overflow;
+	return 1;
+}
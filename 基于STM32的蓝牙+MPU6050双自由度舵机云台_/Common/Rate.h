@@ -0,0 +1,78 @@
+#ifndef __RATE_H
+#define __RATE_H
+
+#include <stdint.h>
+#include "Message.h"
+#include "Link.h"
+
+#define RATE_NODES				4			//发送端最多同时跟踪的接收端数
+#define RATE_REPORT_INTERVAL	200000		//接收端发送链路报告的间隔（us）
+#define RATE_TIMEOUT			1000000		//报告超时（us），收不到任何报告时每个超时周期减速一次
+#define RATE_MIN				10			//最低发送速率（包/秒），需高于接收端链路超时对应的速率
+#define RATE_STEP				10			//每个无拥塞的报告周期增加的速率（包/秒）
+#define RATE_LOSS_HIGH			50			//丢包率高于此值（‰）时减速
+#define RATE_LOSS_LOW			10			//丢包率低于此值（‰）时加速，介于两者之间保持
+#define RATE_HOLDOFF			400000		//减速后不再调整的时间（us），等待减速的效果反映到报告中
+#define RATE_TOKEN				1000000		//一个包对应的令牌数
+
+/**
+ * @brief 减速原因，记录最近一次减速的依据
+ */
+#define RATE_REASON_NONE		0			//未减速
+#define RATE_REASON_LOSS		1			//丢包率过高（蓝牙丢帧为主）
+#define RATE_REASON_CRC			2			//丢包率过高（CRC错误为主，蓝牙模块缓冲区溢出丢字节时也表现为CRC错误）
+#define RATE_REASON_OVERFLOW	3			//接收端串口或接收缓冲区溢出，来不及处理
+#define RATE_REASON_BLOCKED		4			//流控窗口已满，数据在链路中排队
+#define RATE_REASON_SILENT		5			//收不到链路报告
+
+/**
+ * @brief 一个接收端最近一次的链路报告
+ */
+typedef struct {
+	uint8_t Valid;						//已收到过该接收端的报告
+	uint8_t Node;						//接收端地址
+	MsgLinkReport Last;					//上次的累计计数
+	uint32_t Time;						//收到报告的时间（us）
+} RateNode;
+
+/**
+ * @brief 自适应发送速率（发送端）
+ * @note 按接收端定期发来的累计接收、丢包、CRC错误和溢出计数做加性增、乘性减（AIMD）：
+ *       报告周期内丢包率高于RATE_LOSS_HIGH、接收端溢出或本端流控窗口已满时速率减半，
+ *       低于RATE_LOSS_LOW时增加RATE_STEP，链路退化时数据不再堆积在蓝牙模块中，恢复后逐步回到满速；
+ *       按令牌桶发出，最多积攒一个包，不会突发；减速期间发送的总是当时最新的姿态；
+ *       多个接收端时任一接收端拥塞即减速；从未收到报告（旧版本接收端）时不限速；
+ *       中断超过RATE_TIMEOUT后恢复的接收端，第一个报告只作为新的基准，不把中断期间的丢包计入
+ */
+typedef struct {
+	RateNode Node[RATE_NODES];
+	uint16_t Max;						//最高速率（包/秒），即主循环频率
+	uint16_t Rate;						//当前速率（包/秒）
+	uint8_t Active;						//已收到过链路报告，开始限速
+	uint8_t Reason;						//最近一次减速的原因，RATE_REASON_*
+	uint16_t Loss;						//最近一次报告周期内的丢包率（‰）
+	uint32_t Tokens;					//令牌，RATE_TOKEN为一个包
+	uint32_t Last;						//上次补充令牌的时间（us）
+	uint32_t LastReport;				//最近一次收到任一接收端报告的时间（us）
+	uint32_t LastDecrease;				//最近一次减速的时间（us）
+	uint32_t Blocked;					//上次报告时流控的累计推迟次数
+	uint32_t Paced;						//因速率限制推迟的次数
+	uint32_t Decreases;					//减速次数
+} Rate;
+
+/**
+ * @brief 链路报告（接收端）
+ */
+typedef struct {
+	uint32_t Time;						//上次报告的时间（us）
+} RateAdvert;
+
+extern const char *const Rate_ReasonText[];
+
+void Rate_Init(Rate *R, uint16_t Max);
+void Rate_OnReport(Rate *R, uint8_t Node, const MsgLinkReport *Report, uint32_t Blocked, uint32_t Now);
+uint8_t Rate_Ready(Rate *R, uint32_t Now);
+uint8_t Rate_Density(const Rate *R, uint8_t Limit);
+uint8_t Rate_MakeReport(RateAdvert *Adv, const LinkStats *Stats, uint32_t Overflow, uint32_t Now, MsgLinkReport *Report);
+
+#endif
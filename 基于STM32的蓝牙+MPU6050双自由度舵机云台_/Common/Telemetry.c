@@ -0,0 +1,192 @@
+#include "stm32f10x.h"                  // Device header
+#include <string.h>
+#include "Telemetry.h"
+#include "Link.h"
+#include "Proto.h"
+#include "Message.h"
+#include "Log.h"
+
+/**
+  * @brief  遥测串口发送环形缓冲区
+  * @note   主循环写入Head，DMA1通道7从Tail开始发送一段连续数据，传输完成中断中前移Tail
+  *         并发送下一段；缓冲区末尾回绕时分两段发送。空出一个字节区分满和空
+  */
+static uint8_t Telemetry_Buf[TELEMETRY_BUF_SIZE];
+static volatile uint16_t Telemetry_Head;		//下一个写入位置（主循环）
+static volatile uint16_t Telemetry_Tail;		//下一个发送位置（DMA中断）
+static volatile uint16_t Telemetry_Sending;		//DMA正在发送的字节数，0表示空闲
+static uint8_t Telemetry_Seq;					//遥测数据包序号，与蓝牙链路的序号无关
+
+uint32_t Telemetry_Dropped;						//缓冲区空间不足而丢弃的数据包数
+
+/**
+  * @brief  遥测串口初始化
+  * @param  无
+  * @retval 无
+  * @note   USART2只发送，PA2为TX（与LED2共用引脚，固件不使用LED2），接USB转串口；
+  *         发送由DMA1通道7完成，不占用CPU；蓝牙串口（USART1）只传控制数据
+  */
+void Telemetry_Init(void)
+{
+	RCC_APB1PeriphClockCmd(RCC_APB1Periph_USART2, ENABLE);
+	RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+	
+	GPIO_InitTypeDef GPIO_InitStructure;
+	GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;				//PA2为USART2_TX，复用推挽输出
+	GPIO_InitStructure.GPIO_Pin = GPIO_Pin_2;
+	GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+	GPIO_Init(GPIOA, &GPIO_InitStructure);
+	
+	USART_InitTypeDef USART_InitStructure;
+	USART_InitStructure.USART_BaudRate = TELEMETRY_BAUD;
+	USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
+	USART_InitStructure.USART_Mode = USART_Mode_Tx;					//只发送
+	USART_InitStructure.USART_Parity = USART_Parity_No;
+	USART_InitStructure.USART_StopBits = USART_StopBits_1;
+	USART_InitStructure.USART_WordLength = USART_WordLength_8b;
+	USART_Init(USART2, &USART_InitStructure);
+	
+	DMA_InitTypeDef DMA_InitStructure;
+	DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&USART2->DR;
+	DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+	DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+	DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)Telemetry_Buf;
+	DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+	DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+	DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;				//内存到外设
+	DMA_InitStructure.DMA_BufferSize = TELEMETRY_BUF_SIZE;
+	DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+	DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+	DMA_InitStructure.DMA_Priority = DMA_Priority_Low;				//低于蓝牙串口
+	DMA_Init(DMA1_Channel7, &DMA_InitStructure);
+	DMA_ITConfig(DMA1_Channel7, DMA_IT_TC, ENABLE);
+	USART_DMACmd(USART2, USART_DMAReq_Tx, ENABLE);
+	
+	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_2);
+	
+	NVIC_InitTypeDef NVIC_InitStructure;
+	NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel7_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;		//低于蓝牙串口的收发中断
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 2;
+	NVIC_Init(&NVIC_InitStructure);
+	
+	USART_Cmd(USART2, ENABLE);
+}
+
+/**
+  * @brief  启动DMA发送Tail开始的一段连续数据（需在关中断或DMA中断中调用）
+  * @param  无
+  * @retval 无
+  */
+static void Telemetry_Start(void)
+{
+	uint16_t Head = Telemetry_Head;
+	uint16_t Tail = Telemetry_Tail;
+	
+	if (Head == Tail)
+	{
+		Telemetry_Sending = 0;
+		return;
+	}
+	Telemetry_Sending = (Head > Tail) ? Head - Tail : TELEMETRY_BUF_SIZE - Tail;
+	DMA_Cmd(DMA1_Channel7, DISABLE);							//修改地址和长度前需先关闭通道
+	DMA1_Channel7->CMAR = (uint32_t)&Telemetry_Buf[Tail];
+	DMA_SetCurrDataCounter(DMA1_Channel7, Telemetry_Sending);
+	DMA_Cmd(DMA1_Channel7, ENABLE);
+}
+
+/**
+  * @brief  写入一段数据
+  * @param  Data 数据
+  * @param  Length 长度
+  * @retval 1表示已写入，0表示缓冲区空间不足、整段丢弃
+  * @note   只在主循环中调用；不等待串口，数据由DMA在后台发出
+  */
+uint8_t Telemetry_Write(const uint8_t *Data, uint16_t Length)
+{
+	uint16_t Head = Telemetry_Head;
+	uint16_t Used = (uint16_t)(Head - Telemetry_Tail + TELEMETRY_BUF_SIZE) % TELEMETRY_BUF_SIZE;
+	uint16_t First;
+	
+	if (Length > TELEMETRY_BUF_SIZE - 1 - Used) {return 0;}
+	
+	First = TELEMETRY_BUF_SIZE - Head;							//到缓冲区末尾的空间
+	if (First > Length) {First = Length;}
+	memcpy(&Telemetry_Buf[Head], Data, First);
+	memcpy(Telemetry_Buf, Data + First, Length - First);
+	
+	__disable_irq();
+	Telemetry_Head = (Head + Length) % TELEMETRY_BUF_SIZE;
+	if (Telemetry_Sending == 0)
+	{
+		Telemetry_Start();										//DMA空闲则立即开始发送
+	}
+	__enable_irq();
+	return 1;
+}
+
+/**
+  * @brief  以数据包形式发送一条协议消息
+  * @param  Type 消息类型
+  * @param  Body 消息体
+  * @param  Length 消息体长度，不超过PROTO_MAX_BODY
+  * @retval 1表示已写入，0表示缓冲区空间不足而丢弃
+  * @note   格式与蓝牙链路相同（COBS + [序号][协议头][消息][CRC-16]，见Link.h、Proto.h），
+  *         主机端工具（Tools/log_decode.py）可直接解码；目标地址为PROTO_ADDR_HOST
+  */
+uint8_t Telemetry_SendMessage(uint8_t Type, const void *Body, uint8_t Length)
+{
+	uint8_t Packet[LINK_MAX_DATA];
+	uint8_t Buf[LINK_MAX_ENCODED];
+	uint8_t Size = Proto_BeginTo(Packet, PROTO_ADDR_HOST);
+	
+	Size = Proto_Add(Packet, Size, Type, Body, Length);
+	Size = Link_Pack(Telemetry_Seq, Packet, Size, Buf);
+	if (!Telemetry_Write(Buf, Size))
+	{
+		Telemetry_Dropped ++;
+		return 0;
+	}
+	Telemetry_Seq ++;
+	return 1;
+}
+
+/**
+  * @brief  在后台发出缓存的日志
+  * @param  无
+  * @retval 无
+  * @note   每个主循环调用一次；缓冲区留不出一个完整数据包时留到下一圈，日志不会丢失，
+  *         只有日志缓冲区本身写满时才丢弃（Log_Dropped）；日志格式见Log.h
+  */
+void Telemetry_DrainLog(void)
+{
+	uint32_t Body[LOG_MAX_ARGS + 1];
+	uint8_t Length;
+	uint16_t Used;
+	
+	while (1)
+	{
+		Used = (uint16_t)(Telemetry_Head - Telemetry_Tail + TELEMETRY_BUF_SIZE) % TELEMETRY_BUF_SIZE;
+		if (TELEMETRY_BUF_SIZE - 1 - Used < LINK_MAX_ENCODED) {break;}
+		if ((Length = Log_Pop(Body)) == 0) {break;}
+		Telemetry_SendMessage(MSG_LOG, Body, Length);
+	}
+}
+
+/**
+  * @brief  DMA1通道7中断服务函数（USART2发送完成）
+  * @param  无
+  * @retval 无
+  * @note   前移Tail，有剩余数据则继续发送
+  */
+void DMA1_Channel7_IRQHandler(void)
+{
+	if (DMA_GetITStatus(DMA1_IT_TC7) == SET)
+	{
+		DMA_ClearITPendingBit(DMA1_IT_TC7);		//先清标志，否则下一段恰好在此前完成时其完成中断会被清掉
+		Telemetry_Tail = (Telemetry_Tail + Telemetry_Sending) % TELEMETRY_BUF_SIZE;
+		Telemetry_Start();
+	}
+}
@@ -0,0 +1,17 @@
+#ifndef __TELEMETRY_H
+#define __TELEMETRY_H
+
+#include <stdint.h>
+
+#define TELEMETRY_BAUD			921600		//遥测串口波特率
+#define TELEMETRY_BUF_SIZE		512			//发送环形缓冲区大小（字节），921600波特率下约5.6ms发完
+#define TELEMETRY_INTERVAL		1000000		//运行状态遥测（MSG_TELEMETRY）发送间隔（us）
+
+extern uint32_t Telemetry_Dropped;
+
+void Telemetry_Init(void);
+uint8_t Telemetry_Write(const uint8_t *Data, uint16_t Length);
+uint8_t Telemetry_SendMessage(uint8_t Type, const void *Body, uint8_t Length);
+void Telemetry_DrainLog(void);
+
+#endif
@@ -0,0 +1,78 @@
+#include "stm32f10x.h"                  // Device header
+
+/**
+  * @brief  TIM4溢出计数（高16位），在TIM4更新中断中递增
+  */
+static volatile uint16_t Timer_Overflow;
+
+/**
+  * @brief  微秒时间基准初始化
+  * @param  无
+  * @retval 无
+  * @note   TIM4以1MHz自由运行，16位计数器溢出时由中断扩展为32位微秒计数，
+  *         Delay_us占用SysTick，因此时间戳统一由本模块提供
+  */
+void Timer_Init(void)
+{
+	RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM4, ENABLE);			//开启TIM4的时钟
+	
+	TIM_InternalClockConfig(TIM4);									//选择内部时钟
+	
+	TIM_TimeBaseInitTypeDef TIM_TimeBaseInitStructure;
+	TIM_TimeBaseInitStructure.TIM_ClockDivision = TIM_CKD_DIV1;
+	TIM_TimeBaseInitStructure.TIM_CounterMode = TIM_CounterMode_Up;
+	TIM_TimeBaseInitStructure.TIM_Period = 65536 - 1;				//ARR满量程，16位自由运行
+	TIM_TimeBaseInitStructure.TIM_Prescaler = 72 - 1;				//72MHz/72=1MHz，1个计数=1us
+	TIM_TimeBaseInitStructure.TIM_RepetitionCounter = 0;
+	TIM_TimeBaseInit(TIM4, &TIM_TimeBaseInitStructure);
+	
+	TIM_ClearFlag(TIM4, TIM_FLAG_Update);							//清除TimeBaseInit产生的更新标志
+	TIM_ITConfig(TIM4, TIM_IT_Update, ENABLE);						//开启更新中断
+	
+	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_2);
+	
+	NVIC_InitTypeDef NVIC_InitStructure;
+	NVIC_InitStructure.NVIC_IRQChannel = TIM4_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;		//最高抢占优先级，保证其他中断中读取的时间戳不回退
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+	NVIC_Init(&NVIC_InitStructure);
+	
+	TIM_Cmd(TIM4, ENABLE);
+}
+
+/**
+  * @brief  获取当前微秒时间戳
+  * @param  无
+  * @retval 上电以来的微秒数，约71.6分钟回绕一次，做差时用无符号减法即可
+  */
+uint32_t Timer_GetMicros(void)
+{
+	uint16_t High;
+	uint16_t Low;
+	do
+	{
+		High = Timer_Overflow;
+		Low = TIM_GetCounter(TIM4);
+	} while (High != Timer_Overflow);								//读取期间发生溢出中断则重读
+	
+	if (TIM_GetFlagStatus(TIM4, TIM_FLAG_Update) == SET && Low < 0x8000)
+	{
+		High++;													//中断被屏蔽时溢出尚未计入，手动补上
+	}
+	return ((uint32_t)High << 16) | Low;
+}
+
+/**
+  * @brief  TIM4更新中断，扩展高16位
+  * @param  无
+  * @retval 无
+  */
+void TIM4_IRQHandler(void)
+{
+	if (TIM_GetITStatus(TIM4, TIM_IT_Update) == SET)
+	{
+		Timer_Overflow++;
+		TIM_ClearITPendingBit(TIM4, TIM_IT_Update);
+	}
+}
@@ -0,0 +1,9 @@
+#ifndef __TIMER_H
+#define __TIMER_H
+
+#include <stdint.h>
+
+void Timer_Init(void);
+uint32_t Timer_GetMicros(void);
+
+#endif
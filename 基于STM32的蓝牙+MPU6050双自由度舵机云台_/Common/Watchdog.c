@@ -0,0 +1,131 @@
+#include "stm32f10x.h"                  // Device header
+#include "Watchdog.h"
+
+/**
+  * @brief  备份寄存器布局
+  * @note   BKP_DR1存放有效标志，BKP_DR2起存放状态字，最后一个状态字之后存放校验和，
+  *         校验和在状态字之后写入，写到一半发生复位时校验失败，不会恢复出错的状态
+  */
+#define WATCHDOG_MAGIC		0xA55A
+#define WATCHDOG_DR(i)		((uint16_t)(BKP_DR1 + 4 * (i)))	//BKP_DR1~BKP_DR10地址连续，间隔4
+
+static uint8_t Watchdog_WarmStart;		//本次启动是否为热启动（看门狗/软件/复位键复位）
+
+/**
+  * @brief  计算状态字校验和
+  * @param  State 状态字数组
+  * @param  Num 状态字个数
+  * @retval 校验和
+  */
+static uint16_t Watchdog_Checksum(const uint16_t *State, uint8_t Num)
+{
+	uint16_t Sum = WATCHDOG_MAGIC;
+	uint8_t i;
+	for (i = 0; i < Num; i++)
+	{
+		Sum = (uint16_t)((Sum << 1) | (Sum >> 15)) ^ State[i];	//循环左移后异或，顺序错位也能检出
+	}
+	return Sum;
+}
+
+/**
+  * @brief  看门狗与备份域初始化
+  * @param  TimeoutMs 看门狗超时时间（ms），范围：2~6552
+  * @retval 无
+  * @note   应在主循环开始前最后调用，初始化期间的长延时不会触发复位；
+  *         需先调用Watchdog_IsWarmStart读取复位原因
+  */
+void Watchdog_Init(uint16_t TimeoutMs)
+{
+	uint32_t Reload = (uint32_t)TimeoutMs * 625 / 1000;		//LSI 40kHz / 64 = 625Hz，1个计数=1.6ms
+	if (Reload > 0x0FFF) {Reload = 0x0FFF;}
+	if (Reload == 0) {Reload = 1;}
+	
+	IWDG_WriteAccessCmd(IWDG_WriteAccess_Enable);			//解除IWDG寄存器写保护
+	IWDG_SetPrescaler(IWDG_Prescaler_64);
+	IWDG_SetReload((uint16_t)Reload);
+	IWDG_ReloadCounter();
+	IWDG_Enable();											//启动后无法关闭，复位后需重新启动
+}
+
+/**
+  * @brief  喂狗
+  * @param  无
+  * @retval 无
+  */
+void Watchdog_Feed(void)
+{
+	IWDG_ReloadCounter();
+}
+
+/**
+  * @brief  判断本次启动是否为热启动，并开启备份寄存器访问
+  * @param  无
+  * @retval 1表示热启动（可恢复状态），0表示上电冷启动
+  * @note   上电复位(POR)时即使VBAT保持了备份寄存器，也按冷启动处理，
+  *         首次调用时读取并清除复位标志，之后返回缓存结果
+  */
+uint8_t Watchdog_IsWarmStart(void)
+{
+	static uint8_t Checked = 0;
+	
+	if (!Checked)
+	{
+		Checked = 1;
+		RCC_APB1PeriphClockCmd(RCC_APB1Periph_PWR | RCC_APB1Periph_BKP, ENABLE);	//开启PWR和BKP的时钟
+		PWR_BackupAccessCmd(ENABLE);											//允许写备份寄存器
+		
+		Watchdog_WarmStart = (RCC_GetFlagStatus(RCC_FLAG_PORRST) == RESET)
+		                  && (BKP_ReadBackupRegister(WATCHDOG_DR(0)) == WATCHDOG_MAGIC);
+		RCC_ClearFlag();														//清除复位标志，供下次复位判断
+	}
+	return Watchdog_WarmStart;
+}
+
+/**
+  * @brief  将状态字保存到备份寄存器
+  * @param  State 状态字数组
+  * @param  Num 状态字个数，范围：1~WATCHDOG_STATE_MAX
+  * @retval 无
+  * @note   每个主循环调用一次，写备份寄存器只需几个总线周期
+  */
+void Watchdog_SaveState(const uint16_t *State, uint8_t Num)
+{
+	uint8_t i;
+	
+	if (Num > WATCHDOG_STATE_MAX) {Num = WATCHDOG_STATE_MAX;}
+	
+	BKP_WriteBackupRegister(WATCHDOG_DR(0), WATCHDOG_MAGIC);
+	for (i = 0; i < Num; i++)
+	{
+		BKP_WriteBackupRegister(WATCHDOG_DR(i + 1), State[i]);
+	}
+	BKP_WriteBackupRegister(WATCHDOG_DR(Num + 1), Watchdog_Checksum(State, Num));
+}
+
+/**
+  * @brief  从备份寄存器恢复状态字
+  * @param  State 用于接收状态字的数组
+  * @param  Num 状态字个数，范围：1~WATCHDOG_STATE_MAX
+  * @retval 1表示热启动且校验通过，State已更新；0表示无可用状态，State不变
+  */
+uint8_t Watchdog_LoadState(uint16_t *State, uint8_t Num)
+{
+	uint16_t Buf[WATCHDOG_STATE_MAX];
+	uint8_t i;
+	
+	if (Num > WATCHDOG_STATE_MAX) {Num = WATCHDOG_STATE_MAX;}
+	if (!Watchdog_IsWarmStart()) {return 0;}
+	
+	for (i = 0; i < Num; i++)
+	{
+		Buf[i] = BKP_ReadBackupRegister(WATCHDOG_DR(i + 1));
+	}
+	if (BKP_ReadBackupRegister(WATCHDOG_DR(Num + 1)) != Watchdog_Checksum(Buf, Num)) {return 0;}
+	
+	for (i = 0; i < Num; i++)
+	{
+		State[i] = Buf[i];
+	}
+	return 1;
+}
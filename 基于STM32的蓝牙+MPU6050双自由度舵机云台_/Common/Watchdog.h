@@ -0,0 +1,12 @@
+#ifndef __WATCHDOG_H
+#define __WATCHDOG_H
+
+#define WATCHDOG_STATE_MAX	7			//可保存的状态字数（BKP_DR2~BKP_DR8，BKP_DR10留给HC05）
+
+void Watchdog_Init(uint16_t TimeoutMs);
+void Watchdog_Feed(void);
+uint8_t Watchdog_IsWarmStart(void);
+void Watchdog_SaveState(const uint16_t *State, uint8_t Num);
+uint8_t Watchdog_LoadState(uint16_t *State, uint8_t Num);
+
+#endif
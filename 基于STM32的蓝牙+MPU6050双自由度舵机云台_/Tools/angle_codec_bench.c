@@ -0,0 +1,136 @@
+/*
+ * 角度差分编码基准
+ *
+ * 用Common/中与单片机相同的AngleCodec、Proto、Link代码，把一段录制的角度逐帧编码，
+ * 与每帧都发送绝对角度（关键帧）相比，统计平均每帧字节数和每秒节省的字节数，并逐帧解码核对。
+ *
+ * 编译运行（在Tools目录下）：
+ *     gcc -O2 -I../Common angle_codec_bench.c ../Common/AngleCodec.c ../Common/Proto.c \
+ *         ../Common/Link.c ../Common/Crc.c -lm -o angle_codec_bench
+ *     ./angle_codec_bench samples.csv      # 录制的运动
+ *     ./angle_codec_bench                  # 内置的合成运动（静止、慢速转动、快速甩动）
+ *
+ * 录制方法：python log_decode.py Objects/Project.axf COM5 921600 --samples > samples.csv，
+ * 每行为"时间戳,加速度X,Y,Z,角度1,角度2"（角度单位0.1°），非数据行跳过；
+ * 按每行一帧、主循环频率（1000/LOOP_INTERVAL）计算每秒字节数，不考虑死区省略的帧。
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "AngleCodec.h"
+#include "Message.h"
+#include "Proto.h"
+#include "Link.h"
+#include "Gimbal.h"
+
+#define SYNTH_SECONDS	60		//合成运动的时长（秒）
+
+typedef struct {
+	uint32_t Frames;
+	uint32_t Keys;
+	uint32_t CodecBytes;		//角度帧字节数
+	uint32_t LinkBytes;			//编码后整帧（COBS + 序号 + CRC + 协议头 + 消息）字节数
+	uint32_t AbsCodecBytes;		//每帧都为关键帧时的角度帧字节数
+	uint32_t AbsLinkBytes;
+	uint32_t Errors;			//解码结果与原值不一致的帧数
+} Bench;
+
+static AngleEncoder Encoder;
+static AngleDecoder Decoder;
+
+/* 一帧角度消息经协议层和链路层编码后的长度 */
+static uint8_t LinkSize(uint16_t Stamp, const uint8_t *Codec, uint8_t Length)
+{
+	uint8_t Packet[LINK_MAX_DATA];
+	uint8_t Frame[LINK_MAX_ENCODED];
+	MsgAngle Angle;
+	uint8_t i, Size;
+
+	Angle.Stamp = Stamp;
+	for (i = 0; i < Length; i ++) {Angle.Codec[i] = Codec[i];}
+	Size = Proto_Begin(Packet);
+	Size = Proto_Add(Packet, Size, MSG_ANGLE, &Angle, MSG_ANGLE_LENGTH(Length));
+	return Link_Pack(0, Packet, Size, Frame);
+}
+
+static void Feed(Bench *B, uint16_t Stamp, uint16_t A1, uint16_t A2)
+{
+	uint8_t Codec[ANGLE_MAX_LENGTH];
+	uint8_t Key[ANGLE_KEY_LENGTH] = {ANGLE_KEY_FLAG};
+	uint16_t D1, D2;
+	uint8_t Length = AngleCodec_Encode(&Encoder, A1, A2, Codec);
+
+	if (Codec[0] & ANGLE_KEY_FLAG) {B->Keys ++;}
+	if (!AngleCodec_Decode(&Decoder, Codec, Length, &D1, &D2) || D1 != A1 || D2 != A2) {B->Errors ++;}
+	B->Frames ++;
+	B->CodecBytes += Length;
+	B->LinkBytes += LinkSize(Stamp, Codec, Length);
+	Key[1] = (uint8_t)A1; Key[2] = (uint8_t)(A1 >> 8);
+	Key[3] = (uint8_t)A2; Key[4] = (uint8_t)(A2 >> 8);
+	B->AbsCodecBytes += ANGLE_KEY_LENGTH;
+	B->AbsLinkBytes += LinkSize(Stamp, Key, ANGLE_KEY_LENGTH);
+}
+
+static int LoadCsv(Bench *B, const char *Path)
+{
+	FILE *F = fopen(Path, "r");
+	char Line[128];
+	unsigned Stamp, A1, A2;
+	int Ax, Ay, Az;
+
+	if (F == 0) {perror(Path); return 0;}
+	while (fgets(Line, sizeof(Line), F))
+	{
+		if (sscanf(Line, "%u,%d,%d,%d,%u,%u", &Stamp, &Ax, &Ay, &Az, &A1, &A2) == 6)
+		{
+			Feed(B, (uint16_t)Stamp, (uint16_t)A1, (uint16_t)A2);
+		}
+	}
+	fclose(F);
+	return 1;
+}
+
+/* 合成运动：每10秒依次为静止（±0.1°噪声）、慢速转动、快速甩动，模拟手持操作 */
+static void Synthesize(Bench *B)
+{
+	uint32_t Rate = 1000 / LOOP_INTERVAL, n;
+	double t, a1, a2;
+
+	srand(1);
+	for (n = 0; n < SYNTH_SECONDS * Rate; n ++)
+	{
+		t = (double)n / Rate;
+		switch ((n / (10 * Rate)) % 3)
+		{
+		case 0:  a1 = 90; a2 = 90; break;
+		case 1:  a1 = 90 + 30 * sin(t * 0.8); a2 = 90 + 40 * sin(t * 0.5); break;
+		default: a1 = 90 + 55 * sin(t * 6.0); a2 = 90 + 80 * sin(t * 4.0); break;
+		}
+		a1 += (rand() % 3 - 1) * 0.1;
+		a2 += (rand() % 3 - 1) * 0.1;
+		Feed(B, (uint16_t)(n * LOOP_INTERVAL), (uint16_t)(a1 * 10 + 0.5), (uint16_t)(a2 * 10 + 0.5));
+	}
+}
+
+int main(int argc, char **argv)
+{
+	Bench B = {0};
+	double Rate = 1000.0 / LOOP_INTERVAL, Seconds;
+
+	AngleCodec_EncoderInit(&Encoder);
+	AngleCodec_DecoderInit(&Decoder);
+	if (argc > 1) {if (!LoadCsv(&B, argv[1])) {return 1;}}
+	else {Synthesize(&B);}
+	if (B.Frames == 0) {fprintf(stderr, "没有样本\n"); return 1;}
+
+	Seconds = B.Frames / Rate;
+	printf("样本%lu帧（%.1f秒，%.0fHz），关键帧%lu，解码错误%lu\n", (unsigned long)B.Frames, Seconds, Rate,
+		(unsigned long)B.Keys, (unsigned long)B.Errors);
+	printf("角度帧：绝对%.2f字节/帧  差分%.2f字节/帧  节省%.0f字节/秒（%.1f%%）\n",
+		(double)B.AbsCodecBytes / B.Frames, (double)B.CodecBytes / B.Frames,
+		(B.AbsCodecBytes - B.CodecBytes) / Seconds, 100.0 * (B.AbsCodecBytes - B.CodecBytes) / B.AbsCodecBytes);
+	printf("整帧：  绝对%.2f字节/帧  差分%.2f字节/帧  节省%.0f字节/秒（%.1f%%）\n",
+		(double)B.AbsLinkBytes / B.Frames, (double)B.LinkBytes / B.Frames,
+		(B.AbsLinkBytes - B.LinkBytes) / Seconds, 100.0 * (B.AbsLinkBytes - B.LinkBytes) / B.AbsLinkBytes);
+	return B.Errors ? 1 : 0;
+}
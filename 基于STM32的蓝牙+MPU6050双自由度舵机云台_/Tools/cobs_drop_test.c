@@ -0,0 +1,137 @@
+/*
+ * COBS链路丢字节测试
+ *
+ * 用Common/中与单片机相同的Link代码，把一串数据包经Link_Pack编码后逐字节送入Link_Decode，
+ * 途中按给定概率随机丢弃字节，统计每次丢字节后到下一个有效数据包之间损坏的帧数和字节数，
+ * 验证任何字节丢失最多只损坏所在的帧（丢的是定界符时为相邻两帧），下一个定界符处即恢复同步，
+ * 且损坏的帧不会通过CRC被误交付。
+ *
+ * 编译运行（在Tools目录下）：
+ *     gcc -O2 -I../Common cobs_drop_test.c ../Common/Link.c ../Common/Crc.c -o cobs_drop_test
+ *     ./cobs_drop_test
+ *
+ * 数据包内容为[4字节包编号][角度帧]，角度值随机，包含0x00、0xFE、0xFF等旧帧格式中的标记字节；
+ * 有误交付或单次丢字节的恢复超过2帧时返回非0。
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Link.h"
+
+#define PACKETS		200000		//每种丢字节概率仿真的数据包数
+#define DATA_LEN	12			//数据长度（4字节包编号 + 随机内容）
+
+typedef struct {
+	uint32_t Drops;				//丢弃的字节数
+	uint32_t Events;			//恢复事件数（两个有效数据包之间有丢字节）
+	uint32_t Isolated;			//只丢了一个字节的恢复事件数
+	uint32_t Delivered;			//交付的数据包数
+	uint32_t Wrong;				//内容与发出的不一致却通过校验的数据包数
+	uint32_t LostFrames;		//损坏的数据包总数
+	uint32_t MaxFrames;			//单次恢复损坏的最多数据包数
+	uint32_t MaxIsolated;		//只丢一个字节时损坏的最多数据包数
+	uint64_t RecoverBytes;		//从第一个丢弃的字节到下一个有效数据包结束的字节数之和
+	uint32_t MaxBytes;
+} Result;
+
+static double Rand(void)
+{
+	return rand() / (RAND_MAX + 1.0);
+}
+
+/* 第n个数据包的内容，由编号确定，接收时据此核对 */
+static void MakeData(uint32_t n, uint8_t *Data)
+{
+	static const uint8_t Marker[] = {0x00, 0xFE, 0xFF};
+	uint32_t x = n * 2654435761u + 1;
+	uint8_t j;
+
+	memcpy(Data, &n, 4);
+	for (j = 4; j < DATA_LEN; j ++)
+	{
+		x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+		Data[j] = (x % 4 == 0) ? Marker[(x >> 8) % 3] : (uint8_t)(x >> 16);
+	}
+}
+
+static int Run(double Drop, Result *R)
+{
+	LinkDecoder Decoder;
+	LinkStats Stats;
+	uint8_t Data[DATA_LEN], Expect[DATA_LEN];
+	uint8_t Frame[LINK_MAX_ENCODED];
+	uint8_t Size, i, Length;
+	uint32_t n, Got, Last = 0;
+	uint64_t Byte = 0, FirstDrop = 0;
+	uint32_t Pending = 0;		//自上一个有效数据包以来丢弃的字节数
+
+	memset(R, 0, sizeof(*R));
+	Link_DecoderInit(&Decoder);
+	Link_StatsInit(&Stats);
+	srand(1);
+
+	for (n = 1; n <= PACKETS; n ++)
+	{
+		MakeData(n, Data);
+		Size = Link_Pack((uint8_t)n, Data, DATA_LEN, Frame);
+		for (i = 0; i < Size; i ++, Byte ++)
+		{
+			if (Rand() < Drop)
+			{
+				if (Pending ++ == 0) {FirstDrop = Byte;}
+				R->Drops ++;
+				continue;
+			}
+			Length = Link_Decode(&Decoder, Frame[i]);
+			if (Length == 0 || Link_Check(&Stats, Decoder.Data, Length) != DATA_LEN) {continue;}
+
+			memcpy(&Got, &Decoder.Data[1], 4);
+			MakeData(Got, Expect);
+			if (Got > PACKETS || memcmp(&Decoder.Data[1], Expect, DATA_LEN) != 0)
+			{
+				R->Wrong ++;
+				continue;
+			}
+			R->Delivered ++;
+			if (Pending > 0)
+			{
+				uint32_t Frames = Got - Last - 1;
+				uint32_t Bytes = (uint32_t)(Byte + 1 - FirstDrop);
+				R->Events ++;
+				R->LostFrames += Frames;
+				R->RecoverBytes += Bytes;
+				if (Frames > R->MaxFrames) {R->MaxFrames = Frames;}
+				if (Bytes > R->MaxBytes) {R->MaxBytes = Bytes;}
+				if (Pending == 1)
+				{
+					R->Isolated ++;
+					if (Frames > R->MaxIsolated) {R->MaxIsolated = Frames;}
+				}
+				Pending = 0;
+			}
+			Last = Got;
+		}
+	}
+	return R->Wrong == 0 && R->MaxIsolated <= 2;
+}
+
+int main(void)
+{
+	static const double Drops[] = {0.0001, 0.001, 0.01, 0.05};
+	Result R;
+	uint8_t k;
+	int Ok = 1;
+
+	for (k = 0; k < sizeof(Drops) / sizeof(Drops[0]); k ++)
+	{
+		Ok &= Run(Drops[k], &R);
+		printf("丢字节%5.2f%%  丢弃%6lu  交付%6lu  误交付%lu  恢复%6lu次  每次损坏%4.2f帧（最多%lu，单字节最多%lu）"
+			"  恢复%5.1f字节（最多%lu）\n",
+			Drops[k] * 100, (unsigned long)R.Drops, (unsigned long)R.Delivered, (unsigned long)R.Wrong,
+			(unsigned long)R.Events, R.Events ? (double)R.LostFrames / R.Events : 0.0,
+			(unsigned long)R.MaxFrames, (unsigned long)R.MaxIsolated,
+			R.Events ? (double)R.RecoverBytes / R.Events : 0.0, (unsigned long)R.MaxBytes);
+	}
+	printf(Ok ? "通过\n" : "失败\n");
+	return Ok ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+/*
+ * 前向纠错信道仿真
+ *
+ * 用Common/中与单片机相同的Link、Fec代码，模拟125Hz的角度数据包经过有丢帧和误码的
+ * 蓝牙串口，统计不同组大小下的残余丢包率、还原包数、还原包增加的时延和带宽开销。
+ *
+ * 编译运行（在Tools目录下）：
+ *     gcc -O2 -I../Common fec_sim.c ../Common/Fec.c ../Common/Link.c ../Common/Crc.c -o fec_sim
+ *     ./fec_sim
+ *
+ * 信道模型：每帧以一定概率整帧丢失（蓝牙重连、缓冲区溢出），以一定概率有一个字节出错；
+ * 丢失按Gilbert模型成串出现（上一帧丢失时本帧丢失概率为BURST）。
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Link.h"
+#include "Fec.h"
+
+#define PACKETS		200000		//每种配置仿真的数据包数
+#define PERIOD_MS	8			//数据包间隔（125Hz）
+#define DATA_LEN	10			//数据长度（协议头 + 角度消息）
+#define BURST		0.3			//上一帧丢失时本帧也丢失的概率
+
+typedef struct {
+	LinkDecoder Decoder;
+	LinkStats Stats;
+	FecDecoder Fec;
+	uint32_t Received[256];		//各序号最近一次交付时的数据包编号 + 1
+	uint32_t Delivered;
+	uint32_t Repaired;
+	uint32_t DelaySum;			//还原包相对原本到达时刻的延迟（包间隔数）之和
+	uint32_t Bytes;
+	uint32_t Now;				//当前数据包编号
+	int LastLost;
+} Channel;
+
+static double Rand(void)
+{
+	return rand() / (RAND_MAX + 1.0);
+}
+
+static void Deliver(Channel *C, uint32_t Packet, int Repaired)
+{
+	C->Delivered ++;
+	if (Repaired)
+	{
+		C->Repaired ++;
+		C->DelaySum += C->Now - Packet;
+	}
+}
+
+/* 一帧经过信道：可能整帧丢失或一个字节出错，然后逐字节送入接收端 */
+static void Transmit(Channel *C, const uint8_t *Frame, uint8_t Size, double Loss, double Corrupt)
+{
+	uint8_t Buf[LINK_MAX_ENCODED];
+	uint8_t Repaired[LINK_MAX_DATA];
+	uint8_t i, Length, Data;
+	double P = C->LastLost ? BURST : Loss;
+
+	C->Bytes += Size;
+	C->LastLost = Rand() < P;
+	if (C->LastLost) {return;}
+	memcpy(Buf, Frame, Size);
+	if (Rand() < Corrupt)
+	{
+		Buf[rand() % (Size - 1)] ^= (uint8_t)(1 + rand() % 255);
+	}
+	for (i = 0; i < Size; i ++)
+	{
+		Length = Link_Decode(&C->Decoder, Buf[i]);
+		if (Length == 0) {continue;}
+		Data = Link_Check(&C->Stats, C->Decoder.Data, Length);
+		if (Data > 0)
+		{
+			Fec_Store(&C->Fec, C->Decoder.Data[0], &C->Decoder.Data[1], Data);
+			Deliver(C, C->Decoder.Data[1] | (uint32_t)C->Decoder.Data[2] << 8 | (uint32_t)C->Decoder.Data[3] << 16, 0);
+		}
+		else if (Link_IsParity(C->Decoder.Data, Length))
+		{
+			if (Fec_Repair(&C->Fec, C->Decoder.Data, Length, Repaired) > 0)
+			{
+				Deliver(C, Repaired[0] | (uint32_t)Repaired[1] << 8 | (uint32_t)Repaired[2] << 16, 1);
+			}
+		}
+	}
+}
+
+static void Run(uint8_t Group, double Loss, double Corrupt)
+{
+	static Channel C;
+	FecEncoder E;
+	uint8_t Data[DATA_LEN];
+	uint8_t Frame[LINK_MAX_ENCODED];
+	uint8_t Parity[LINK_MAX_ENCODED];
+	uint8_t Size, j;
+	uint32_t n;
+
+	memset(&C, 0, sizeof(C));
+	Link_DecoderInit(&C.Decoder);
+	Link_StatsInit(&C.Stats);
+	Fec_DecoderInit(&C.Fec);
+	Fec_EncoderInit(&E, Group);
+	srand(1);
+
+	for (n = 0; n < PACKETS; n ++)
+	{
+		C.Now = n;
+		Data[0] = (uint8_t)n;				//前3字节为数据包编号，便于计算还原时延
+		Data[1] = (uint8_t)(n >> 8);
+		Data[2] = (uint8_t)(n >> 16);
+		for (j = 3; j < DATA_LEN; j ++) {Data[j] = (uint8_t)rand();}
+		Size = Fec_Encode(&E, (uint8_t)n, Data, DATA_LEN, Parity);
+		if (Size > 0) {Transmit(&C, Parity, Size, Loss, Corrupt);}
+		Size = Link_Pack((uint8_t)n, Data, DATA_LEN, Frame);
+		Transmit(&C, Frame, Size, Loss, Corrupt);
+	}
+
+	printf("N=%u  丢帧%4.1f%%  误码%4.1f%%  残余丢包%6.3f%%  还原%6lu  还原时延%5.1fms  开销%5.1f%%\n",
+		Group, Loss * 100, Corrupt * 100,
+		100.0 * (PACKETS - C.Delivered) / PACKETS,
+		(unsigned long)C.Repaired,
+		C.Repaired ? (double)C.DelaySum * PERIOD_MS / C.Repaired : 0.0,
+		100.0 * C.Bytes / (PACKETS * (DATA_LEN + LINK_OVERHEAD + 2.0)) - 100);
+}
+
+int main(void)
+{
+	static const uint8_t Groups[] = {0, 2, 4, 7};
+	static const double Losses[] = {0.01, 0.05};
+	uint8_t g, l;
+
+	for (l = 0; l < sizeof(Losses) / sizeof(Losses[0]); l ++)
+	{
+		for (g = 0; g < sizeof(Groups); g ++)
+		{
+			Run(Groups[g], Losses[l], 0.01);
+		}
+	}
+	return 0;
+}
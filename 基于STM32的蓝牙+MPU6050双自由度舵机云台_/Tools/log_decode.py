@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+二进制日志解码工具
+
+单片机上的LOG宏只发送格式字符串的地址和原始参数（MSG_LOG消息，见Common/Log.h），
+本工具从Keil生成的.axf中按地址取回格式字符串并完成格式化。
+
+用法：
+    python log_decode.py Objects/Project.axf capture.bin      # 解码串口抓包文件
+    python log_decode.py Objects/Project.axf -                # 从标准输入读取
+    python log_decode.py Objects/Project.axf COM5 921600      # 直接读遥测串口（需要pyserial）
+    python log_decode.py Objects/Project.axf COM5 921600 --samples   # 同时输出原始样本
+
+日志、统计和原始样本由各板的遥测串口（USART2 TX，PA2，921600波特率，见Common/Telemetry.c）发出，
+接USB转串口即可读取，不占用蓝牙链路。
+
+串口数据为COBS帧（0x00结尾），帧内为[序号][数据][CRC16低字节][CRC16高字节]，
+数据为[协议版本][目标][来源]后接若干[类型][长度][消息体]，与Common/Link.c、Common/Proto.c一致；
+MSG_TELEMETRY每秒输出一行运行状态，MSG_SAMPLE（--samples）每个样本输出一行逗号分隔的数值，
+其余消息忽略。.axf需与单片机中运行的程序为同一次编译的结果。
+消息类型和消息体格式取自msg_layout.py，由msg_layout.c按Common/Message.h生成，修改消息后需重新生成。
+"""
+import os
+import re
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from msg_layout import (PROTO_VERSION, PROTO_HEADER, MSG_TELEMETRY, MSG_LOG, MSG_SAMPLE,
+                        MSG_TELEMETRY_FORMAT, MSG_SAMPLE_FORMAT)
+
+PROTO_MAJOR = PROTO_VERSION >> 4
+
+
+class Image:
+    """读取ELF32（.axf）中加载到Flash/RAM的段，按地址取数据"""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF' or self.data[4] != 1:
+            raise ValueError('不是32位ELF文件: ' + path)
+        shoff, = struct.unpack_from('<I', self.data, 0x20)
+        shentsize, shnum = struct.unpack_from('<HH', self.data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            _, stype, flags, addr, offset, size = struct.unpack_from('<IIIIII', self.data, shoff + i * shentsize)
+            if stype == 1 and flags & 0x2 and size > 0:  # SHT_PROGBITS且SHF_ALLOC
+                self.sections.append((addr, size, offset))
+
+    def string(self, addr):
+        for base, size, offset in self.sections:
+            if base <= addr < base + size:
+                start = offset + addr - base
+                end = self.data.index(b'\x00', start)
+                return self.data[start:end].decode('gbk', 'replace')
+        return '<0x%08X?>' % addr
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame):
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+def format_log(image, fmt, args):
+    """按printf写法格式化，%s参数为字符串地址"""
+    values = iter(args)
+
+    def repl(m):
+        spec = m.group(0)
+        if spec == '%%':
+            return '%'
+        value = next(values, 0)
+        conv = spec[-1]
+        spec = re.sub(r'[lh]', '', spec)
+        if conv == 's':
+            return spec % image.string(value)
+        if conv in 'di':
+            value = struct.unpack('<i', struct.pack('<I', value))[0]
+        return spec % value
+
+    return re.sub(r'%[-+ 0#]*\d*(?:\.\d+)?[lh]*[diuxXcs%]', repl, fmt)
+
+
+def packets(stream):
+    frame = bytearray()
+    while True:
+        chunk = stream.read(1)
+        if not chunk:
+            return
+        if chunk[0] != 0:
+            frame += chunk
+            continue
+        payload = cobs_decode(bytes(frame))
+        frame.clear()
+        if payload is None or len(payload) < 4:
+            continue
+        if crc16(payload[:-2]) != payload[-2] | (payload[-1] << 8):
+            continue
+        yield payload[1:-2]
+
+
+def messages(packet):
+    if PROTO_MAJOR != packet[0] >> 4:
+        return
+    i = PROTO_HEADER - 2
+    while i + 2 <= len(packet):
+        mtype, length = packet[i], packet[i + 1]
+        yield mtype, packet[i + 2:i + 2 + length]
+        i += 2 + length
+
+
+def main():
+    args = [a for a in sys.argv[1:] if a != '--samples']
+    samples = len(args) < len(sys.argv) - 1
+    if len(args) < 2:
+        print(__doc__)
+        return 1
+    image = Image(args[0])
+    if args[1] == '-':
+        stream = sys.stdin.buffer
+    elif len(args) > 2:
+        import serial
+        stream = serial.Serial(args[1], int(args[2]))
+    else:
+        stream = open(args[1], 'rb')
+
+    for packet in packets(stream):
+        for mtype, body in messages(packet):
+            if mtype == MSG_LOG and len(body) >= 4:
+                words = struct.unpack('<%dI' % (len(body) // 4), body[:len(body) // 4 * 4])
+                text = format_log(image, image.string(words[0]), words[1:])
+            elif mtype == MSG_TELEMETRY and len(body) == struct.calcsize(MSG_TELEMETRY_FORMAT):
+                rtt, age, lost, source, quality, loop_max = struct.unpack(MSG_TELEMETRY_FORMAT, body)
+                text = 'TEL src=%u rtt=%u age=%u lost=%u q=%u loop=%u\n' % (
+                    source, rtt, age, lost, quality, loop_max)
+            elif mtype == MSG_SAMPLE and len(body) == struct.calcsize(MSG_SAMPLE_FORMAT) and samples:
+                text = '%u,%d,%d,%d,%u,%u\n' % struct.unpack(MSG_SAMPLE_FORMAT, body)
+            else:
+                continue
+            sys.stdout.write(text.replace('\r\n', '\n'))
+            sys.stdout.flush()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
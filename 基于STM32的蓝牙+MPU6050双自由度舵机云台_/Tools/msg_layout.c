@@ -0,0 +1,92 @@
+/*
+ * 消息布局导出
+ *
+ * 包含与单片机相同的Common/Message.h，按MSG_LIST输出全部消息类型及长度，并把主机端工具
+ * 需要解码的消息体导出为Python struct格式字符串，生成Tools/msg_layout.py供log_decode.py导入。
+ * 字段表逐项与offsetof、sizeof比对：字段顺序、类型或长度与Message.h不一致时报错退出，不生成。
+ *
+ * 编译运行（在Tools目录下），修改Message.h后重新生成：
+ *     gcc -Wall -I../Common msg_layout.c -o msg_layout
+ *     ./msg_layout > msg_layout.py
+ */
+#include <stdio.h>
+#include <stddef.h>
+#include "Message.h"
+
+typedef struct {
+	size_t Offset;
+	size_t Size;				//字段总字节数
+	size_t Count;				//数组元素个数，标量为1
+	int Signed;
+} Field;
+
+#define SCALAR(T, F)	{offsetof(T, F), sizeof(((T *)0)->F), 1, (double)(__typeof__(((T *)0)->F))-1 < 0}
+#define ARRAY(T, F)		{offsetof(T, F), sizeof(((T *)0)->F), sizeof(((T *)0)->F) / sizeof(((T *)0)->F[0]), \
+						 (double)(__typeof__(((T *)0)->F[0]))-1 < 0}
+
+/* 主机端工具解码的消息体，字段按Message.h中的顺序列出 */
+static const Field Telemetry[] = {
+	SCALAR(MsgTelemetry, RttAvg), SCALAR(MsgTelemetry, AgeAvg), SCALAR(MsgTelemetry, Lost),
+	SCALAR(MsgTelemetry, Source), SCALAR(MsgTelemetry, Quality), SCALAR(MsgTelemetry, LoopMax),
+};
+static const Field Sample[] = {
+	SCALAR(MsgSample, Stamp), ARRAY(MsgSample, Accel), ARRAY(MsgSample, Angle),
+};
+static const Field LinkReport[] = {
+	SCALAR(MsgLinkReport, Received), SCALAR(MsgLinkReport, Lost),
+	SCALAR(MsgLinkReport, CrcErrors), SCALAR(MsgLinkReport, Overflow),
+};
+
+/* 检查字段首尾相接、总长等于消息体长度，输出格式字符串；失败返回0 */
+static int Export(const char *Name, const Field *F, size_t Count, size_t Size, size_t Length)
+{
+	static const char Code[2][5] = {{0, 'B', 'H', 0, 'I'}, {0, 'b', 'h', 0, 'i'}};
+	char Fmt[64];
+	size_t i, j, Offset = 0, n = 0;
+
+	Fmt[n ++] = '<';
+	for (i = 0; i < Count; i ++)
+	{
+		size_t Element = F[i].Size / F[i].Count;
+		if (F[i].Offset != Offset || Element > 4 || Code[F[i].Signed][Element] == 0)
+		{
+			fprintf(stderr, "%s: 第%u个字段与Message.h不符（偏移%u，期望%u）\n",
+				Name, (unsigned)i, (unsigned)F[i].Offset, (unsigned)Offset);
+			return 0;
+		}
+		for (j = 0; j < F[i].Count; j ++) {Fmt[n ++] = Code[F[i].Signed][Element];}
+		Offset += F[i].Size;
+	}
+	Fmt[n] = 0;
+	if (Offset != Size || Size != Length)
+	{
+		fprintf(stderr, "%s: 字段共%u字节，结构体%u字节，MSG_LIST登记%u字节\n",
+			Name, (unsigned)Offset, (unsigned)Size, (unsigned)Length);
+		return 0;
+	}
+	printf("%s_FORMAT = '%s'\n", Name, Fmt);
+	return 1;
+}
+
+#define PRINT_TYPE(Type, Body, Min, Max)	printf("%-18s = 0x%02X\n", #Type, Type);
+#define PRINT_LENGTH(Type, Body, Min, Max)	printf("    %s: (%u, %u),\n", #Type, (unsigned)(Min), (unsigned)(Max));
+#define EXPORT(Type, Body, Table)	Export(#Type, Table, sizeof(Table) / sizeof(Table[0]), sizeof(Body), Type##_LENGTH)
+
+int main(void)
+{
+	int Ok = 1;
+
+	printf("# -*- coding: utf-8 -*-\n");
+	printf("# 由Tools/msg_layout.c根据Common/Message.h生成，请勿手工修改\n\n");
+	printf("PROTO_VERSION = 0x%02X\n", PROTO_VERSION);
+	printf("PROTO_HEADER = %u\n\n", PROTO_HEADER);
+	MSG_LIST(PRINT_TYPE)
+	printf("\n# 消息体长度范围：类型 -> (最小, 最大)\n");
+	printf("MSG_LENGTH = {\n");
+	MSG_LIST(PRINT_LENGTH)
+	printf("}\n\n");
+	Ok &= EXPORT(MSG_TELEMETRY, MsgTelemetry, Telemetry);
+	Ok &= EXPORT(MSG_SAMPLE, MsgSample, Sample);
+	Ok &= EXPORT(MSG_LINK_REPORT, MsgLinkReport, LinkReport);
+	return Ok ? 0 : 1;
+}
@@ -0,0 +1,44 @@
+# -*- coding: utf-8 -*-
+# 由Tools/msg_layout.c根据Common/Message.h生成，请勿手工修改
+
+PROTO_VERSION = 0x20
+PROTO_HEADER = 5
+
+MSG_ANGLE          = 0x01
+MSG_PING           = 0x02
+MSG_PONG           = 0x03
+MSG_PARAM_GET      = 0x04
+MSG_PARAM_SET      = 0x05
+MSG_PARAM_ACK      = 0x06
+MSG_QUAT           = 0x07
+MSG_TELEMETRY      = 0x08
+MSG_HEARTBEAT      = 0x09
+MSG_ANGLE_BATCH    = 0x0B
+MSG_LOG            = 0x0C
+MSG_CREDIT         = 0x0D
+MSG_SAMPLE         = 0x0E
+MSG_LINK_REPORT    = 0x0F
+MSG_STAT_REQUEST   = 0x10
+
+# 消息体长度范围：类型 -> (最小, 最大)
+MSG_LENGTH = {
+    MSG_ANGLE: (3, 9),
+    MSG_PING: (4, 4),
+    MSG_PONG: (12, 12),
+    MSG_PARAM_GET: (1, 21),
+    MSG_PARAM_SET: (1, 21),
+    MSG_PARAM_ACK: (2, 22),
+    MSG_QUAT: (8, 8),
+    MSG_TELEMETRY: (16, 16),
+    MSG_HEARTBEAT: (0, 8),
+    MSG_ANGLE_BATCH: (12, 24),
+    MSG_LOG: (4, 24),
+    MSG_CREDIT: (2, 2),
+    MSG_SAMPLE: (12, 12),
+    MSG_LINK_REPORT: (8, 8),
+    MSG_STAT_REQUEST: (0, 1),
+}
+
+MSG_TELEMETRY_FORMAT = '<IIIBBH'
+MSG_SAMPLE_FORMAT = '<HhhhHH'
+MSG_LINK_REPORT_FORMAT = '<HHHH'
@@ -1,13 +1,34 @@
 #include "stm32f10x.h"                  // Device header
-#include <stdio.h>
-#include <stdarg.h>
+#include <string.h>
+#include "Serial.h"
+#include "Timer.h"
 
 /**
  * @brief 串口全局变量定义
  */
-uint8_t Serial_TxPacket[4];  // 串口发送数据包
-uint8_t Serial_RxPacket[4];  // 串口接收数据包
-uint8_t Serial_RxFlag;       // 串口接收完成标志
+FrameQueue Serial_RxQueue;   // 串口接收帧队列：接收中断生产，主循环消费
+LinkDecoder Serial_RxDecoder;   // 串口接收COBS解码器（仅在接收中断中使用）
+LinkStats Serial_RxStats;       // 串口接收数据包统计（CRC、序号）
+
+/**
+ * @brief DMA双缓冲发送
+ * @note 一个缓冲区由DMA1通道4发送时，新数据写入另一个缓冲区，发送完成中断中交换；
+ *       Serial_TxSending为正在发送（或最近发送）的缓冲区编号，另一个即为填充缓冲区
+ */
+#define SERIAL_TX_NO_FRAME 0xFFFF
+#define SERIAL_TX_RAW_FRAME 0x00  // Serial_SendFrame发出的原始帧的替换类型（不与任何消息类型重复）
+
+static uint8_t Serial_TxBuf[2][SERIAL_TX_BUF_SIZE];  // 发送缓冲区
+static volatile uint16_t Serial_TxLen[2];            // 各缓冲区待发送字节数
+static volatile uint8_t Serial_TxSending;            // 正在发送的缓冲区编号
+static volatile uint8_t Serial_TxBusy;               // DMA发送进行中标志
+static uint16_t Serial_TxFrameStart = SERIAL_TX_NO_FRAME;  // 填充缓冲区末尾那一帧的起始位置，可被新帧覆盖
+static uint8_t Serial_TxSeq;         // 下一个数据包的序号
+static uint8_t Serial_TxFrameSeq;    // 填充缓冲区末尾那一帧的序号，替换该帧时沿用
+static uint8_t Serial_TxFrameType;   // 填充缓冲区末尾那一帧的消息类型，只有同类型的新帧可以替换它
+uint32_t Serial_TxCoalesced;  // 尚未发出即被新帧替换的帧数
+uint32_t Serial_TxDropped;    // 缓冲区满而丢弃的帧数
+FecEncoder Serial_TxFec;      // 前向纠错：每组数据包后插入异或校验帧
 
 /**
  * @brief 串口初始化函数
@@ -16,6 +37,11 @@ uint8_t Serial_RxFlag;       // 串口接收完成标志
  * @note 配置USART1，波特率9600，8位数据位，1位停止位，无校验位
  */
 void Serial_Init(void){
+	FrameQueue_Init(&Serial_RxQueue);  // 开启接收中断前初始化接收队列
+	Link_DecoderInit(&Serial_RxDecoder);  // 初始化COBS解码器
+	Link_StatsInit(&Serial_RxStats);  // 清零接收统计
+	Fec_EncoderInit(&Serial_TxFec, 0);  // 前向纠错默认关闭
+	
 	// 使能USART1和GPIOA时钟
 	RCC_APB2PeriphClockCmd(RCC_APB2Periph_USART1, ENABLE);
 	RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);
@@ -46,6 +72,24 @@ void Serial_Init(void){
 	// 开启USART1接收中断
 	USART_ITConfig(USART1, USART_IT_RXNE, ENABLE);
 	
+	// 配置DMA1通道4（USART1_TX）：内存到外设，每次发送前再设置地址和长度
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+	DMA_InitTypeDef DMA_InitStructure;
+	DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&USART1->DR;       // 外设地址：USART1数据寄存器
+	DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+	DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+	DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)Serial_TxBuf[0];
+	DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+	DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+	DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;                      // 内存到外设
+	DMA_InitStructure.DMA_BufferSize = SERIAL_TX_BUF_SIZE;
+	DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+	DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+	DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;
+	DMA_Init(DMA1_Channel4, &DMA_InitStructure);
+	DMA_ITConfig(DMA1_Channel4, DMA_IT_TC, ENABLE);                         // 开启传输完成中断
+	USART_DMACmd(USART1, USART_DMAReq_Tx, ENABLE);                          // USART1发送请求交给DMA
+	
 	// 配置NVIC优先级分组
 	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_2);
 	
@@ -57,18 +101,60 @@ void Serial_Init(void){
 	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 1;             // 子优先级1
 	NVIC_Init(&NVIC_InitStructure);                                // 初始化NVIC
 	
+	// 配置DMA1通道4中断
+	NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel4_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 2;             // 子优先级2
+	NVIC_Init(&NVIC_InitStructure);
+	
 	// 使能USART1
 	USART_Cmd(USART1, ENABLE);
 }
 
+/**
+ * @brief 修改USART1波特率
+ * @param BaudRate 新的波特率
+ * @retval 无
+ * @note 先等待发送缓冲区清空，避免正在发送的数据以错误速率发出
+ */
+void Serial_SetBaudRate(uint32_t BaudRate){
+	Serial_Flush();
+	USART_Cmd(USART1, DISABLE);
+	
+	USART_InitTypeDef USART_InitStructure;
+	USART_InitStructure.USART_BaudRate = BaudRate;
+	USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
+	USART_InitStructure.USART_Mode = USART_Mode_Tx | USART_Mode_Rx;
+	USART_InitStructure.USART_Parity = USART_Parity_No;
+	USART_InitStructure.USART_StopBits = USART_StopBits_1;
+	USART_InitStructure.USART_WordLength = USART_WordLength_8b;
+	USART_Init(USART1, &USART_InitStructure);
+	
+	USART_Cmd(USART1, ENABLE);
+}
+
+/**
+ * @brief 启动DMA发送指定缓冲区
+ * @param Index 缓冲区编号
+ * @retval 无
+ * @note 需在关中断或DMA中断中调用
+ */
+static void Serial_TxStart(uint8_t Index){
+	Serial_TxSending = Index;
+	Serial_TxBusy = 1;
+	Serial_TxFrameStart = SERIAL_TX_NO_FRAME;  // 新的填充缓冲区中还没有帧
+	DMA_Cmd(DMA1_Channel4, DISABLE);           // 修改地址和长度前需先关闭通道
+	DMA1_Channel4->CMAR = (uint32_t)Serial_TxBuf[Index];
+	DMA_SetCurrDataCounter(DMA1_Channel4, Serial_TxLen[Index]);
+	DMA_Cmd(DMA1_Channel4, ENABLE);
+}
+
 /**
  * @brief 发送一个字节数据
  * @param Byte 要发送的字节数据
  * @retval 无
  */
 void Serial_SendByte(uint8_t Byte){
-	USART_SendData(USART1, Byte);  // 发送数据
-	while (USART_GetFlagStatus(USART1, USART_FLAG_TXE) == RESET);  // 等待发送完成
+	Serial_SendArray(&Byte, 1);
 }
 
 /**
@@ -76,11 +162,225 @@ void Serial_SendByte(uint8_t Byte){
  * @param Array 要发送的数组指针
  * @param Length 数组长度
  * @retval 无
+ * @note 数据复制到填充缓冲区后立即返回，由DMA在后台发送；
+ *       只有填充缓冲区写满时才等待正在进行的发送完成
  */
 void Serial_SendArray(uint8_t *Array, uint16_t Length){
-	uint16_t i;
-	for(i=0; i<Length; i++){  // 循环发送数组中的每个字节
-		Serial_SendByte(Array[i]);
+	uint8_t Fill;
+	uint16_t Count;
+	
+	while(Length > 0){
+		__disable_irq();
+		Fill = 1 - Serial_TxSending;  // 填充缓冲区
+		Count = SERIAL_TX_BUF_SIZE - Serial_TxLen[Fill];
+		if(Count > Length){
+			Count = Length;
+		}
+		memcpy(&Serial_TxBuf[Fill][Serial_TxLen[Fill]], Array, Count);  // 追加到填充缓冲区
+		Serial_TxLen[Fill] += Count;
+		Serial_TxFrameStart = SERIAL_TX_NO_FRAME;  // 帧之后追加了普通数据，该帧不再可替换
+		if(!Serial_TxBusy && Serial_TxLen[Fill] > 0){
+			Serial_TxStart(Fill);  // DMA空闲则立即开始发送
+		}
+		__enable_irq();
+		
+		Array += Count;
+		Length -= Count;
+		if(Length > 0){
+			while(Serial_TxLen[1 - Serial_TxSending] >= SERIAL_TX_BUF_SIZE);  // 填充缓冲区已满，等待DMA交换缓冲区
+		}
+	}
+}
+
+/**
+ * @brief 把一帧写入填充缓冲区，尚未发出的旧帧被新帧替换（需在关中断时调用）
+ * @param Array 帧数据指针
+ * @param Length 帧长度，不超过SERIAL_TX_BUF_SIZE
+ * @retval 无
+ */
+static void Serial_TxPutFrame(uint8_t *Array, uint16_t Length){
+	uint8_t Fill = 1 - Serial_TxSending;
+	
+	if(Serial_TxFrameStart != SERIAL_TX_NO_FRAME){
+		Serial_TxLen[Fill] = Serial_TxFrameStart;  // 丢弃末尾尚未发出的旧帧
+		Serial_TxCoalesced++;
+	}
+	if(Serial_TxLen[Fill] + Length <= SERIAL_TX_BUF_SIZE){
+		Serial_TxFrameStart = Serial_TxLen[Fill];
+		memcpy(&Serial_TxBuf[Fill][Serial_TxLen[Fill]], Array, Length);
+		Serial_TxLen[Fill] += Length;
+		if(!Serial_TxBusy){
+			Serial_TxStart(Fill);
+		}
+	}
+	else{
+		Serial_TxFrameStart = SERIAL_TX_NO_FRAME;
+		Serial_TxDropped++;  // 缓冲区被其他数据占满，丢弃本帧
+	}
+}
+
+/**
+ * @brief 发送一帧数据，尚未发出的旧帧被新帧替换
+ * @param Array 帧数据指针
+ * @param Length 帧长度，不超过SERIAL_TX_BUF_SIZE
+ * @retval 无
+ * @note 用于角度帧等只关心最新值的数据：若填充缓冲区末尾是上一个原始帧且还没轮到发送，
+ *       直接用新帧覆盖，避免旧姿态排队增加延迟；末尾是数据包时追加在其后。不会阻塞
+ */
+void Serial_SendFrame(uint8_t *Array, uint16_t Length){
+	__disable_irq();
+	if(Serial_TxFrameType != SERIAL_TX_RAW_FRAME){
+		Serial_TxFrameStart = SERIAL_TX_NO_FRAME;
+	}
+	Serial_TxPutFrame(Array, Length);
+	Serial_TxFrameType = SERIAL_TX_RAW_FRAME;
+	__enable_irq();
+}
+
+/**
+ * @brief 以带序号和CRC的数据包发送数据，尚未发出的同类型旧包被新包替换
+ * @param Data 数据
+ * @param Length 数据长度，不超过LINK_MAX_DATA
+ * @param Type 消息类型，只有同类型的包才互相替换
+ * @param Replaceable 1表示本包在发出前可被下一个同类型的包替换，0表示本包必须发出（如角度关键帧）
+ * @retval 无
+ * @note 替换旧包时沿用旧包的序号，对端不会把被替换的包计为丢失；类型不同时旧包保留，
+ *       新包用新序号追加在其后，例如PONG不会覆盖等待中的角度差分帧；
+ *       打开前向纠错时，上一组数据包确定后（出现新序号）先发出该组的校验帧
+ */
+void Serial_SendLink(const uint8_t *Data, uint8_t Length, uint8_t Type, uint8_t Replaceable){
+	uint8_t Buf[LINK_MAX_ENCODED];
+	uint8_t Size;
+	
+	__disable_irq();
+	if(Serial_TxFrameType != Type){
+		Serial_TxFrameStart = SERIAL_TX_NO_FRAME;  // 等待中的包类型不同，保留并追加在其后
+	}
+	if(Serial_TxFrameStart == SERIAL_TX_NO_FRAME){
+		Serial_TxFrameSeq = Serial_TxSeq++;
+	}
+	Size = Fec_Encode(&Serial_TxFec, Serial_TxFrameSeq, Data, Length, Buf);
+	if(Size > 0){
+		Serial_TxPutFrame(Buf, Size);
+		Serial_TxFrameStart = SERIAL_TX_NO_FRAME;  // 校验帧不可被替换
+	}
+	Serial_TxPutFrame(Buf, Link_Pack(Serial_TxFrameSeq, Data, Length, Buf));
+	Serial_TxFrameType = Type;
+	if(!Replaceable){
+		Serial_TxFrameStart = SERIAL_TX_NO_FRAME;  // 之后的包追加在其后
+	}
+	__enable_irq();
+}
+
+/**
+ * @brief 立即结束前向纠错的当前组并发出其校验帧
+ * @param 无
+ * @retval 无
+ * @note 发送暂停（静止时省略角度帧）时调用，组内最后一个包不必等到下一个包出现才得到保护；
+ *       等待中的包随之确定，之后的包追加在其后；当前组为空或前向纠错关闭时不发送
+ */
+void Serial_FlushFec(void){
+	uint8_t Buf[LINK_MAX_ENCODED];
+	uint8_t Size;
+	
+	__disable_irq();
+	Size = Fec_Flush(&Serial_TxFec, Buf);
+	if(Size > 0){
+		Serial_TxFrameStart = SERIAL_TX_NO_FRAME;  // 已计入校验帧的包不可再被替换
+		Serial_TxPutFrame(Buf, Size);
+		Serial_TxFrameStart = SERIAL_TX_NO_FRAME;  // 校验帧不可被替换
+	}
+	__enable_irq();
+}
+
+/**
+ * @brief 设置前向纠错的组大小
+ * @param Group 每组数据包数，0表示关闭，最大FEC_MAX_GROUP
+ * @retval 无
+ * @note 每Group个数据包增加一个校验帧，接收端可还原每组中丢失的一个包；未满的组被放弃
+ */
+void Serial_SetFec(uint8_t Group){
+	if(Group == Serial_TxFec.Group){
+		return;
+	}
+	__disable_irq();
+	Fec_EncoderInit(&Serial_TxFec, Group);
+	__enable_irq();
+}
+
+/**
+ * @brief 下一个数据包的链路序号
+ * @param 无
+ * @retval 序号
+ * @note 与接收端通告的确认序号比较，得到在途数据包数（见Flow.h）
+ */
+uint8_t Serial_TxNextSeq(void){
+	return Serial_TxSeq;
+}
+
+/**
+ * @brief 发送一条协议消息
+ * @param Type 消息类型
+ * @param Body 消息体
+ * @param Length 消息体长度，不超过PROTO_MAX_BODY
+ * @param Replaceable 1表示发出前可被下一个包替换，0表示必须发出
+ * @retval 无
+ * @note 数据包格式见Proto.h，发给默认目标（Proto_SetAddress），经Serial_SendLink加序号和CRC后发送
+ */
+void Serial_SendMessage(uint8_t Type, const void *Body, uint8_t Length, uint8_t Replaceable){
+	uint8_t Packet[LINK_MAX_DATA];
+	uint8_t Size = Proto_Begin(Packet);
+	
+	Size = Proto_Add(Packet, Size, Type, Body, Length);
+	Serial_SendLink(Packet, Size, Type, Replaceable);
+}
+
+/**
+ * @brief 向指定节点发送一条协议消息
+ * @param Dest 目标地址，见Proto.h
+ * @param Type 消息类型
+ * @param Body 消息体
+ * @param Length 消息体长度，不超过PROTO_MAX_BODY
+ * @param Replaceable 1表示发出前可被下一个包替换，0表示必须发出
+ * @retval 无
+ * @note 用于应答：目标取Proto_Source()，应答只发回请求的接收端
+ */
+void Serial_SendMessageTo(uint8_t Dest, uint8_t Type, const void *Body, uint8_t Length, uint8_t Replaceable){
+	uint8_t Packet[LINK_MAX_DATA];
+	uint8_t Size = Proto_BeginTo(Packet, Dest);
+	
+	Size = Proto_Add(Packet, Size, Type, Body, Length);
+	Serial_SendLink(Packet, Size, Type, Replaceable);
+}
+
+/**
+ * @brief 等待所有数据发送完毕
+ * @param 无
+ * @retval 无
+ * @note 修改波特率或进入低功耗前调用
+ */
+void Serial_Flush(void){
+	while(Serial_TxBusy);  // 等待DMA搬运完成
+	while(USART_GetFlagStatus(USART1, USART_FLAG_TC) == RESET);  // 等待最后一个字节移出
+}
+
+/**
+ * @brief DMA1通道4中断服务函数（USART1发送完成）
+ * @param 无
+ * @retval 无
+ * @note 当前缓冲区发送完毕后，若填充缓冲区有数据则交换并继续发送
+ */
+void DMA1_Channel4_IRQHandler(void){
+	if(DMA_GetITStatus(DMA1_IT_TC4) == SET){
+		uint8_t Next = 1 - Serial_TxSending;
+		Serial_TxLen[Serial_TxSending] = 0;  // 当前缓冲区已发完，变为填充缓冲区
+		if(Serial_TxLen[Next] > 0){
+			Serial_TxStart(Next);
+		}
+		else{
+			Serial_TxBusy = 0;  // 两个缓冲区都已空，下次写入时重新启动
+		}
+		DMA_ClearITPendingBit(DMA1_IT_TC4);
 	}
 }
 
@@ -90,10 +390,7 @@ void Serial_SendArray(uint8_t *Array, uint16_t Length){
  * @retval 无
  */
 void Serial_SendString(char *String){
-	uint8_t i;
-	for(i=0; String[i] != '\0'; i++){  // 循环发送字符串中的每个字符，直到遇到结束符
-		Serial_SendByte(String[i]);
-	}
+	Serial_SendArray((uint8_t *)String, strlen(String));  // 整串写入发送缓冲区
 }
 
 /**
@@ -124,90 +421,46 @@ void Serial_SendNumber(uint32_t Number, uint8_t Length){
 }
 
 /**
- * @brief 重定向fputc函数，支持printf函数发送数据
- * @param ch 要发送的字符
- * @param f 文件指针
- * @retval 发送的字符
- */
-int fputc(int ch, FILE *f){
-	Serial_SendByte(ch);  // 调用串口发送函数
-	return ch;
-}
-
-/**
- * @brief 串口printf函数，支持格式化输出
- * @param format 格式化字符串
- * @param ... 可变参数列表
- * @retval 无
- */
-void Serial_Printf(char *format, ...){
-	char String[100];  // 定义缓冲区
-	va_list arg;       // 定义可变参数列表
-	va_start(arg, format);  // 初始化可变参数列表
-	vsprintf(String, format, arg);  // 将格式化字符串转换为字符串
-	va_end(arg);  // 结束可变参数列表
-	Serial_SendString(String);  // 发送字符串
-} 
-
-/**
- * @brief 发送数据包
+ * @brief 暂停中断接收，供HC05模块直接查询收发AT指令
  * @param 无
  * @retval 无
- * @note 数据包格式：0xFF + 4字节数据 + 0xFE
  */
-void Serial_SendPacket(void){
-	Serial_SendByte(0xFF);  // 发送帧头
-	Serial_SendArray(Serial_TxPacket, 4);  // 发送数据包内容
-	Serial_SendByte(0xFE);  // 发送帧尾
+void Serial_RxSuspend(void){
+	USART_ITConfig(USART1, USART_IT_RXNE, DISABLE);
 }
 
 /**
- * @brief 获取接收标志
+ * @brief 恢复中断接收
  * @param 无
- * @retval 1表示有新数据接收，0表示无新数据
+ * @retval 无
  */
-uint8_t Serial_GetRxFlag(void){
-	if(Serial_RxFlag == 1){  // 检查接收标志
-		Serial_RxFlag = 0;  // 清除接收标志
-		return 1;  // 返回1表示有新数据
-	}
-	return 0;  // 返回0表示无新数据
+void Serial_RxResume(void){
+	Link_DecoderResync(&Serial_RxDecoder);  // 暂停期间的数据已丢失，丢弃至下一个定界符
+	USART_ClearFlag(USART1, USART_FLAG_ORE);
+	USART_ITConfig(USART1, USART_IT_RXNE, ENABLE);
 }
 
 /**
  * @brief USART1中断服务函数
  * @param 无
  * @retval 无
- * @note 接收数据包格式：0xFF + 4字节数据 + 0xFE
+ * @note 接收数据包格式：COBS编码的[序号 + 数据 + CRC-16] + 0x00定界符；
+ *       每个字节交给COBS解码器，收到定界符后校验CRC和序号，只有有效的数据部分入队，
+ *       主循环不会读到写了一半的帧；丢字节只损坏当前帧，下一个定界符处即恢复同步；
+ *       队列满时本帧丢弃并计入溢出
  */
 void USART1_IRQHandler(void){
-	static uint8_t RxState = 0;  // 接收状态机状态
-	static uint8_t pRxPacket = 0;  // 接收数据包指针
-		
 	if(USART_GetITStatus(USART1, USART_IT_RXNE) == SET){  // 检查是否为接收中断
 		uint8_t RxData = USART_ReceiveData(USART1);  // 读取接收到的数据
+		uint8_t Length = Link_Decode(&Serial_RxDecoder, RxData);  // 逐字节解码
 		
-		// 状态机处理接收数据
-		if(RxState == 0){  // 等待帧头
-			if(RxData == 0xFF){  // 接收到帧头
-				RxState = 1;  // 进入接收数据状态
-				pRxPacket = 0;  // 重置数据包指针
-			}
-		}
-		else if(RxState == 1){  // 接收数据
-			Serial_RxPacket[pRxPacket] = RxData;  // 存储接收到的数据
-			pRxPacket++;  // 数据包指针递增
-			if(pRxPacket >= 4){  // 接收完4字节数据
-				RxState = 2;  // 进入等待帧尾状态
-			}
+		if(Length > 0){  // 收到完整的一帧
+			Length = Link_Check(&Serial_RxStats, Serial_RxDecoder.Data, Length);  // 校验CRC和序号
 		}
-		else if(RxState == 2){  // 等待帧尾
-			if(RxData == 0xFE){  // 接收到帧尾
-				RxState = 0;  // 回到初始状态
-				Serial_RxFlag = 1;  // 设置接收完成标志
-			}
+		if(Length > 0){
+			FrameQueue_Push(&Serial_RxQueue, &Serial_RxDecoder.Data[1], Length, Timer_GetMicros());  // 记录接收时间，用于往返时延测量
 		}
 		
 		USART_ClearITPendingBit(USART1, USART_IT_RXNE);  // 清除接收中断标志
 	}
-}
\ No newline at end of file
+}
@@ -1,22 +1,39 @@
 #ifndef _SERIAL_H
 #define _SERIAL_H
 
-#include <stdio.h>
+#include "FrameQueue.h"
+#include "Link.h"
+#include "Proto.h"
+#include "Fec.h"
 
-extern uint8_t Serial_TxPacket[];
-extern uint8_t Serial_RxPacket[];
+#define SERIAL_TX_BUF_SIZE 128  // DMA发送缓冲区大小（双缓冲，每个缓冲区的字节数）
+
+extern FrameQueue Serial_RxQueue;
+extern LinkDecoder Serial_RxDecoder;
+extern LinkStats Serial_RxStats;
+extern uint32_t Serial_TxCoalesced;
+extern uint32_t Serial_TxDropped;
+extern FecEncoder Serial_TxFec;
 
 void Serial_Init(void);
+void Serial_SetBaudRate(uint32_t BaudRate);
 void Serial_SendByte(uint8_t Byte);
 void Serial_SendArray(uint8_t *Array,uint16_t Length);
+void Serial_SendFrame(uint8_t *Array,uint16_t Length);
+void Serial_SendLink(const uint8_t *Data,uint8_t Length,uint8_t Type,uint8_t Replaceable);
+void Serial_SetFec(uint8_t Group);
+void Serial_FlushFec(void);
+void Serial_SendMessage(uint8_t Type,const void *Body,uint8_t Length,uint8_t Replaceable);
+uint8_t Serial_TxNextSeq(void);
+void Serial_SendMessageTo(uint8_t Dest,uint8_t Type,const void *Body,uint8_t Length,uint8_t Replaceable);
+void Serial_Flush(void);
 void Serial_SendString(char *String);
 uint32_t Serial_Pow(uint32_t X,uint32_t Y);
 void Serial_SendNumber(uint32_t Number,uint8_t Length);
-void Serial_Printf(char *format,...);
 
-void Serial_SendPacket(void);
 
-uint8_t Serial_GetRxFlag(void);
+void Serial_RxSuspend(void);
+void Serial_RxResume(void);
 
 
 #endif
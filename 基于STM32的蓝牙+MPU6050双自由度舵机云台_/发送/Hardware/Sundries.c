@@ -1,33 +1,589 @@
 #include "stm32f10x.h"                  // Device header
+#include <stdlib.h>
 #include "Sundries.h"
 #include "Serial.h"
+#include "Watchdog.h"
+#include "AngleCodec.h"
+#include "Message.h"
+#include "Latency.h"
+#include "Timer.h"
+#include "Param.h"
+#include "Proto.h"
+#include "Log.h"
+#include "Flow.h"
+#include "Rate.h"
+#include "QuatCodec.h"
+#include "Telemetry.h"
+#include "Monitor.h"
+#include <math.h>
 
 /**
  * @brief 外部变量声明
  */
 extern float S1_Filtered, S2_Filtered;  // 滤波后的舵机角度值
 
+/**
+ * @brief 可在线调整的参数，上电为Sundries.h中的默认值
+ */
+TuneParam Tune = {ANGLE_RANGE, FILTER_ALPHA, SERVO1_MIN, SERVO1_MAX, SERVO2_MIN, SERVO2_MAX,
+                  SEND_DEADBAND, SEND_KEEPALIVE, SEND_BATCH, SEND_TARGET, SEND_MODE, FEC_GROUP,
+                  RATE_CONTROL};
+
+/**
+ * @brief 参数组合校验：舵机最小角度必须小于最大角度，发送目标必须是接收端、组或广播地址
+ * @param 无
+ * @retval 1表示合理，0表示不合理
+ */
+static uint8_t Tune_Check(void){
+	uint8_t target = (uint8_t)Tune.SendTarget;
+	
+	return Tune.Servo1Min < Tune.Servo1Max && Tune.Servo2Min < Tune.Servo2Max &&
+	       (target <= PROTO_ADDR_NODE_MAX || target == PROTO_ADDR_BROADCAST ||
+	        (target >= PROTO_ADDR_GROUP(0) && target < PROTO_ADDR_GROUP(PROTO_GROUPS)));
+}
+
+/**
+ * @brief 发送端参数表
+ */
+static const ParamDef Tune_Def[] = {
+	{PARAM_ANGLE_RANGE,  &Tune.AngleRange,  1.0f,  90.0f},
+	{PARAM_FILTER_ALPHA, &Tune.FilterAlpha, 0.01f, 1.0f},
+	{PARAM_SERVO1_MIN,   &Tune.Servo1Min,   0.0f,  180.0f},
+	{PARAM_SERVO1_MAX,   &Tune.Servo1Max,   0.0f,  180.0f},
+	{PARAM_SERVO2_MIN,   &Tune.Servo2Min,   0.0f,  180.0f},
+	{PARAM_SERVO2_MAX,   &Tune.Servo2Max,   0.0f,  180.0f},
+	{PARAM_SEND_DEADBAND,  &Tune.SendDeadband,  0.0f, 10.0f},
+	{PARAM_SEND_KEEPALIVE, &Tune.SendKeepalive, (float)LOOP_INTERVAL, 5000.0f},
+	{PARAM_SEND_BATCH,     &Tune.SendBatch,     1.0f, (float)MSG_BATCH_MAX},
+	{PARAM_SEND_TARGET,    &Tune.SendTarget,    1.0f, (float)PROTO_ADDR_BROADCAST},
+	{PARAM_SEND_MODE,      &Tune.SendMode,      SEND_MODE_ANGLE, SEND_MODE_QUAT},
+	{PARAM_FEC_GROUP,      &Tune.FecGroup,      0.0f, (float)FEC_MAX_GROUP},
+	{PARAM_RATE_CONTROL,   &Tune.RateControl,   0.0f, 1.0f},
+};
+static const ParamTable Tune_Table = {PARAM_DEST_SENDER, Tune_Def, sizeof(Tune_Def) / sizeof(Tune_Def[0]), Tune_Check};
+
+/**
+ * @brief 角度编码器：周期性发送绝对角度关键帧，其间只发送相对关键帧的小差值
+ */
+static AngleEncoder Angle_Encoder;
+
+/**
+ * @brief 接收数据包解析统计
+ */
+ProtoStats Bluetooth_RxStats;
+
+/**
+ * @brief 最近一次发出角度消息的时间（us），用于决定是否补发心跳
+ */
+static uint32_t Bluetooth_LastSend;
+
+/**
+ * @brief 信用流控：接收端窗口已满时推迟发送角度
+ */
+Flow Bluetooth_Flow;
+
+/**
+ * @brief 自适应发送速率：按接收端的链路报告调整发送频率和每条消息的样本数
+ */
+Rate Bluetooth_Rate;
+
+/**
+ * @brief 待发送的批量消息
+ */
+static MsgAngleBatch Angle_Batch;
+
+/**
+ * @brief 发出已累积的批量样本
+ * @param Now 当前时间（us）
+ * @retval 无
+ * @note 批量消息含绝对角度，不依赖关键帧，不可被替换，中间样本不会因替换而丢失
+ */
+static void Bluetooth_FlushBatch(uint32_t Now){
+	if(Angle_Batch.Count == 0){
+		return;
+	}
+	Bluetooth_LastSend = Now;
+	Angle_Batch.Reserved = 0;
+	Serial_SendMessage(MSG_ANGLE_BATCH, &Angle_Batch, MSG_BATCH_LENGTH(Angle_Batch.Count), 0);
+	Angle_Batch.Count = 0;
+}
+
+/**
+ * @brief 将一个样本加入批量消息
+ * @param Stamp 采样时间戳
+ * @param S1 角度1（0.1°）
+ * @param S2 角度2（0.1°）
+ * @param Now 当前时间（us）
+ * @retval 无
+ * @note 样本相对第一个样本的时间超出8位偏移的表示范围（主循环被长时间阻塞）时先发出已有样本；
+ *       攒批期间数据包间隔最长为SEND_BATCH个主循环，接收端链路超时需大于此值
+ */
+static void Bluetooth_AddSample(uint16_t Stamp, uint16_t S1, uint16_t S2, uint32_t Now){
+	uint8_t n;
+	
+	if(Angle_Batch.Count > 0 && (uint16_t)(Stamp - Angle_Batch.Stamp) > 0xFF){
+		Bluetooth_FlushBatch(Now);
+	}
+	n = Angle_Batch.Count;
+	if(n == 0){
+		Angle_Batch.Stamp = Stamp;
+	}
+	Angle_Batch.Offset[n] = (uint8_t)(Stamp - Angle_Batch.Stamp);
+	Angle_Batch.Angle[n][0] = S1;
+	Angle_Batch.Angle[n][1] = S2;
+	Angle_Batch.Count = n + 1;
+	Bluetooth_LastSend = Now;  // 样本已在途，攒批期间不补发心跳
+}
+
+/**
+ * @brief 角度发送统计：当前一秒内的计数及上一秒的结果
+ */
+typedef struct {
+	uint32_t Start;          // 当前统计周期的起始时间（us）
+	uint16_t Sent;           // 当前周期发出的角度消息数
+	uint16_t Suppressed;     // 当前周期因未超出死区而省略的帧数
+	uint16_t Throttled;      // 当前周期因流控窗口已满而推迟的帧数
+	uint16_t Paced;          // 当前周期因自适应速率而推迟的帧数
+	uint16_t SentRate;       // 上一秒发出的角度消息数
+	uint16_t SuppressedRate; // 上一秒省略的帧数
+	uint16_t ThrottledRate;  // 上一秒推迟的帧数
+	uint16_t PacedRate;      // 上一秒因速率推迟的帧数
+} TxCounter;
+static TxCounter Bluetooth_TxCount;
+
+#define TX_SUPPRESSED 0      // 静止，省略本帧
+#define TX_SENT 1            // 已发出
+#define TX_THROTTLED 2       // 接收端窗口已满，推迟到下一周期
+#define TX_PACED 3           // 超出自适应速率，推迟到下一周期
+
+/**
+ * @brief 更新角度发送统计
+ * @param Now 当前时间（us）
+ * @param Result 本帧的结果：TX_SENT、TX_SUPPRESSED、TX_THROTTLED或TX_PACED
+ * @retval 无
+ * @note 每满一秒锁存一次计数，供Bluetooth_Report输出
+ */
+static void Bluetooth_CountTx(uint32_t Now, uint8_t Result){
+	TxCounter *count = &Bluetooth_TxCount;
+	
+	if(Now - count->Start >= 1000000){
+		count->SentRate = count->Sent;
+		count->SuppressedRate = count->Suppressed;
+		count->ThrottledRate = count->Throttled;
+		count->PacedRate = count->Paced;
+		count->Sent = 0;
+		count->Suppressed = 0;
+		count->Throttled = 0;
+		count->Paced = 0;
+		count->Start = (Now - count->Start >= 2000000) ? Now : count->Start + 1000000;  // 长时间阻塞后重新对齐
+	}
+	if(Result == TX_SENT){
+		count->Sent ++;
+	}
+	else if(Result == TX_THROTTLED){
+		count->Throttled ++;
+	}
+	else if(Result == TX_PACED){
+		count->Paced ++;
+	}
+	else{
+		count->Suppressed ++;
+	}
+}
+
 /**
  * @brief 通过蓝牙发送双角度数据
  * @param 无
  * @retval 无
- * @note 发送格式：帧头(0xFF) + S1角度低8位 + S1角度高8位 + S2角度低8位 + S2角度高8位 + 帧尾(0xFE)
+ * @note 消息体为MsgAngle：16位采样时间戳 + 角度帧，角度帧为关键帧（5字节绝对角度）或
+ *       差分帧（通常3字节），格式见AngleCodec.h；时间戳供接收端换算帧龄；
+ *       差分帧可被下一帧替换，关键帧一定发出，避免接收端因关键帧被替换而无法解码；
+ *       两个角度相对上次发出的值都没有超出死区时不发送，保活间隔到期时改发关键帧，
+ *       即使最后一个运动帧丢失，接收端也会收敛到准确角度；打开前向纠错时，省略本帧的同时
+ *       结束当前组并发出校验帧，最后一个运动帧丢失可立即还原，不必等到保活；
+ *       Tune.SendBatch大于1时改为累积样本，攒满或运动停止、保活到期时一起发出；
+ *       接收端通告的窗口已满时本帧推迟（见Flow.h），下一周期发送届时最新的姿态，
+ *       发送速率自动降到接收端和蓝牙链路实际能消化的速率，旧姿态不会在模块缓冲区中排队；
+ *       打开自适应速率时，新消息的第一个样本超出当前速率也推迟，每条消息的样本数由Rate_Density决定，
+ *       已开始的批量消息继续攒满；函数立即返回，不再阻塞等待串口发送
  */
 void Bluetooth_Send_DualAngle(){
+	static uint16_t last_s1 = 0, last_s2 = 0;  // 上次发出的角度
+	static uint32_t last_angle = 0;            // 上次发出角度的时间（us）
+	static uint8_t started = 0;
+	static uint8_t moving = 0;                 // 上次省略之后发出过角度，前向纠错组还未结束
 	// 将浮点角度值转换为整数（扩大10倍，保留一位小数精度）
 	uint16_t s1_int = (uint16_t)(S1_Filtered * 10);
 	uint16_t s2_int = (uint16_t)(S2_Filtered * 10);
+	uint16_t deadband = (uint16_t)(Tune.SendDeadband * 10);
+	uint32_t now = Timer_GetMicros();
+	uint8_t moved = deadband == 0 ||  // 死区为0：每个主循环都发送
+	                abs((int)s1_int - (int)last_s1) > deadband || abs((int)s2_int - (int)last_s2) > deadband;
+	uint8_t batch = (uint8_t)Tune.SendBatch;
+	uint8_t paced = Tune.RateControl != 0;
+	MsgAngle angle;
+	uint8_t length;
+	
+	if(started && !moved){
+		if(now - last_angle < (uint32_t)(Tune.SendKeepalive * 1000)){
+			Bluetooth_CountTx(now, TX_SUPPRESSED);  // 静止：省略本帧
+			Bluetooth_FlushBatch(now);  // 运动停止，不再等待攒满
+			if(moving){
+				Serial_FlushFec();  // 运动停止时立即发出校验帧，最后一个运动帧丢失时接收端马上能还原
+				moving = 0;         // 静止期间只结束一次，之后的心跳照常编组
+			}
+			return;
+		}
+		AngleCodec_ForceKey(&Angle_Encoder);  // 保活：发送自包含的关键帧
+	}
+	if(!Flow_Ready(&Bluetooth_Flow, Serial_TxNextSeq(), now)){
+		Bluetooth_CountTx(now, TX_THROTTLED);  // 不更新上次发出的角度，下一周期按最新角度重新判断
+		return;
+	}
+	if(paced && Angle_Batch.Count == 0 && !Rate_Ready(&Bluetooth_Rate, now)){
+		Bluetooth_CountTx(now, TX_PACED);
+		return;
+	}
+	if(paced){
+		batch = Rate_Density(&Bluetooth_Rate, batch);
+	}
+	started = 1;
+	moving = 1;
+	last_s1 = s1_int;
+	last_s2 = s2_int;
+	last_angle = now;
+	Bluetooth_CountTx(now, TX_SENT);
 	
-	// 构建发送缓冲区
-	uint8_t send_buf[6] = {
-	   ANGLE_FRAME_HEADER,      // 帧头标记（0xFF）
-	    (uint8_t)s1_int,         // S1角度低8位数据
-	    (uint8_t)(s1_int >> 8),  // S1角度高8位数据
-	    (uint8_t)s2_int,         // S2角度低8位数据
-	    (uint8_t)(s2_int >> 8),  // S2角度高8位数据
-	    ANGLE_FRAME_TAIL         // 帧尾标记（0xFE）
-	};
-	
-	// 通过串口（蓝牙）发送数据数组
-	Serial_SendArray(send_buf, 6);
-}
\ No newline at end of file
+	if(batch > 1 || Angle_Batch.Count > 0){
+		Bluetooth_AddSample(Latency_Stamp(now), s1_int, s2_int, now);
+		if(Angle_Batch.Count >= batch || !moved){
+			Bluetooth_FlushBatch(now);  // 攒满，或保活样本立即发出
+		}
+		return;
+	}
+	
+	Bluetooth_LastSend = now;
+	angle.Stamp = Latency_Stamp(now);
+	length = AngleCodec_Encode(&Angle_Encoder, s1_int, s2_int, angle.Codec);
+	
+	// 交给串口DMA发送
+	Serial_SendMessage(MSG_ANGLE, &angle, MSG_ANGLE_LENGTH(length), (angle.Codec[0] & ANGLE_KEY_FLAG) == 0);
+}
+
+/**
+ * @brief 通过蓝牙发送姿态四元数
+ * @param Gx 加速度X（g）
+ * @param Gy 加速度Y（g）
+ * @param Gz 加速度Z（g）
+ * @retval 无
+ * @note 重力方向经Tune.FilterAlpha低通滤波后转换为四元数，压缩为6字节（见QuatCodec.h）；
+ *       与上次发出的姿态相差不超过死区时不发送，保活间隔到期时照常发出；
+ *       四元数是完整姿态，不依赖关键帧，可被下一帧替换；流控和自适应速率与角度模式相同
+ */
+void Bluetooth_Send_Quat(float Gx, float Gy, float Gz){
+	static float g[3] = {0.0f, 0.0f, 1.0f};   // 滤波后的重力方向
+	static Quat last = {1.0f, 0.0f, 0.0f, 0.0f};  // 上次发出的姿态
+	static uint32_t last_quat = 0;            // 上次发出的时间（us）
+	static uint8_t started = 0;
+	static uint8_t moving = 0;                // 上次省略之后发出过姿态，前向纠错组还未结束
+	float alpha = Tune.FilterAlpha;
+	uint32_t now = Timer_GetMicros();
+	Quat q;
+	MsgQuat msg;
+	uint8_t moved;
+	
+	g[0] = Gx * alpha + g[0] * (1 - alpha);
+	g[1] = Gy * alpha + g[1] * (1 - alpha);
+	g[2] = Gz * alpha + g[2] * (1 - alpha);
+	if(!QuatCodec_FromGravity(g[0], g[1], g[2], q)){
+		return;  // 读数异常，保持上次的姿态
+	}
+	
+	// |点积|为两姿态间转角一半的余弦，转角超过死区视为运动；死区为0时每个主循环都发送
+	moved = Tune.SendDeadband <= 0.0f || fabs(QuatCodec_Dot(q, last)) < cos(Tune.SendDeadband * 3.14159f / 360);
+	if(started && !moved && now - last_quat < (uint32_t)(Tune.SendKeepalive * 1000)){
+		Bluetooth_CountTx(now, TX_SUPPRESSED);
+		if(moving){
+			Serial_FlushFec();  // 运动停止时立即发出校验帧
+			moving = 0;
+		}
+		return;
+	}
+	if(!Flow_Ready(&Bluetooth_Flow, Serial_TxNextSeq(), now)){
+		Bluetooth_CountTx(now, TX_THROTTLED);
+		return;
+	}
+	if(Tune.RateControl != 0 && !Rate_Ready(&Bluetooth_Rate, now)){
+		Bluetooth_CountTx(now, TX_PACED);
+		return;
+	}
+	started = 1;
+	moving = 1;
+	last[0] = q[0]; last[1] = q[1]; last[2] = q[2]; last[3] = q[3];
+	last_quat = now;
+	Bluetooth_LastSend = now;
+	Bluetooth_CountTx(now, TX_SENT);
+	
+	msg.Stamp = Latency_Stamp(now);
+	QuatCodec_Pack(q, msg.Packed);
+	Serial_SendMessage(MSG_QUAT, &msg, sizeof(msg), 1);
+}
+
+/**
+ * @brief 输出角度发送统计
+ * @param 无
+ * @retval 无
+ * @note 收到统计请求时与循环监测报告一起输出，sent为上一秒发出的角度消息数，
+ *       sup为因静止而省略的帧数，thr为因流控推迟的帧数，pac为因自适应速率推迟的帧数，
+ *       fly为在途数据包数，blk为累计推迟次数，par为发出的前向纠错校验帧数；
+ *       RATE为自适应速率的状态：当前/最高速率（包/秒）、每条消息的样本数、最近一个报告周期的丢包率（‰）、
+ *       最近一次减速的原因（见Rate.h）和累计减速次数，on为0表示已关闭（仍按报告更新状态）
+ */
+void Bluetooth_Report(void){
+	LOG("TX sent=%u/s sup=%u/s thr=%u/s pac=%u/s", Bluetooth_TxCount.SentRate, Bluetooth_TxCount.SuppressedRate,
+	    Bluetooth_TxCount.ThrottledRate, Bluetooth_TxCount.PacedRate);
+	LOG(" fly=%u blk=%lu par=%lu\r\n", Bluetooth_Flow.InFlight, Bluetooth_Flow.Blocked, Serial_TxFec.Sent);
+	LOG("RATE on=%u hz=%u/%u den=%u loss=%u", (uint8_t)Tune.RateControl, Bluetooth_Rate.Rate, Bluetooth_Rate.Max,
+	    Rate_Density(&Bluetooth_Rate, (uint8_t)Tune.SendBatch), Bluetooth_Rate.Loss);
+	LOG(" why=%s dec=%lu\r\n", (uint32_t)(uintptr_t)Rate_ReasonText[Bluetooth_Rate.Reason], Bluetooth_Rate.Decreases);
+}
+
+/**
+ * @brief 按需发送心跳
+ * @param 无
+ * @retval 无
+ * @note 每个主循环调用一次；超过MSG_HEARTBEAT_INTERVAL没有发出角度消息时补发一次，
+ *       接收端据此判断链路仍然正常，只是没有新的角度；心跳总是广播，角度只发给部分接收端时按间隔定时发送，
+ *       其余接收端不会误判链路中断；心跳只可被更新的心跳替换，串口积压时追加在等待中的角度帧之后，
+ *       不会覆盖同一循环内先发出的角度差分帧
+ */
+void Bluetooth_Send_Heartbeat(void){
+	static uint32_t uptime_ms = 0, last_tick = 0, tick_us = 0, last_beat = 0;
+	uint32_t now = Timer_GetMicros();
+	uint8_t all = (uint8_t)Tune.SendTarget == PROTO_ADDR_BROADCAST;  // 角度消息是否发给全部接收端
+	MsgHeartbeat heartbeat;
+	
+	// 以毫秒累计运行时间，微秒计数器约71分钟回绕一次
+	tick_us += now - last_tick;
+	last_tick = now;
+	uptime_ms += tick_us / 1000;
+	tick_us %= 1000;
+	
+	if(now - (all ? Bluetooth_LastSend : last_beat) < MSG_HEARTBEAT_INTERVAL){
+		return;
+	}
+	Bluetooth_LastSend = now;
+	last_beat = now;
+	heartbeat.Uptime = uptime_ms;
+	heartbeat.Source = PARAM_DEST_SENDER;
+	heartbeat.State = 0;
+	heartbeat.Reserved = 0;
+	Serial_SendMessageTo(PROTO_ADDR_BROADCAST, MSG_HEARTBEAT, &heartbeat, sizeof(heartbeat), 1);
+}
+
+/**
+ * @brief 从遥测串口发出一个原始样本
+ * @param Ax、Ay、Az 加速度计原始值
+ * @retval 无
+ * @note 每个主循环调用一次，同时带上滤波后的舵机目标角度，供主机端分析滤波效果；
+ *       只经遥测串口发出，缓冲区满时丢弃（计入Telemetry_Dropped），不影响蓝牙链路
+ */
+void Telemetry_Send_Sample(int16_t Ax, int16_t Ay, int16_t Az){
+	MsgSample sample;
+	
+	sample.Stamp = Latency_Stamp(Timer_GetMicros());
+	sample.Accel[0] = Ax;
+	sample.Accel[1] = Ay;
+	sample.Accel[2] = Az;
+	sample.Angle[0] = (uint16_t)(S1_Filtered * 10);
+	sample.Angle[1] = (uint16_t)(S2_Filtered * 10);
+	Telemetry_SendMessage(MSG_SAMPLE, &sample, sizeof(sample));
+}
+
+/**
+ * @brief 按周期从遥测串口发出运行状态
+ * @param 无
+ * @retval 无
+ * @note 每个主循环调用一次，每TELEMETRY_INTERVAL发出一条MSG_TELEMETRY；发送端不测量往返时延和帧龄，
+ *       这两项为0，丢包和链路质量为接收端发来的数据包的统计
+ */
+void Telemetry_Send_Status(void){
+	static uint32_t last_send = 0;
+	uint32_t now = Timer_GetMicros();
+	uint32_t loop_max = Monitor_MaxPeriod();
+	MsgTelemetry msg;
+	
+	if(now - last_send < TELEMETRY_INTERVAL){
+		return;
+	}
+	last_send = now;
+	msg.RttAvg = 0;
+	msg.AgeAvg = 0;
+	msg.Lost = Serial_RxStats.Lost;
+	msg.Source = PARAM_DEST_SENDER;
+	msg.Quality = Link_Quality(&Serial_RxStats);
+	msg.LoopMax = (uint16_t)(loop_max > 0xFFFF ? 0xFFFF : loop_max);
+	Telemetry_SendMessage(MSG_TELEMETRY, &msg, sizeof(msg));
+}
+
+/**
+ * @brief 应答接收端的时延探测
+ * @param Type 消息类型
+ * @param Body PING消息体
+ * @param Length 消息体长度
+ * @param Time PING的接收时间（us）
+ * @retval 无
+ * @note PONG带回PING的收到时间和应答时间，接收端据此扣除本端的处理延时；PONG不可被替换，
+ *       只发回发起探测的接收端
+ */
+static void Bluetooth_Reply_Ping(uint8_t Type, const void *Body, uint8_t Length, uint32_t Time){
+	MsgPong pong;
+	
+	Latency_MakePong((const MsgPing *)Body, Time, Timer_GetMicros(), &pong);
+	Serial_SendMessageTo(Proto_Source(), MSG_PONG, &pong, sizeof(pong), 0);
+}
+
+/**
+ * @brief 把参数同步到通信模块
+ * @param 无
+ * @retval 无
+ * @note 上电时和每次读/写参数后调用：角度发送目标（发送端本身地址为PROTO_ADDR_HOST，不加入任何组）、
+ *       前向纠错组大小
+ */
+void Tune_Apply(void){
+	Proto_SetAddress(PROTO_ADDR_HOST, 0, (uint8_t)Tune.SendTarget);
+	Serial_SetFec((uint8_t)Tune.FecGroup);
+}
+
+/**
+ * @brief 处理读/写参数命令
+ * @param Type 消息类型（MSG_PARAM_GET或MSG_PARAM_SET）
+ * @param Body 消息体
+ * @param Length 消息体长度
+ * @param Time 接收时间（us）
+ * @retval 无
+ * @note 只处理目标为发送端的命令，应答回读生效后的值并发回转发命令的接收端；命令在主循环开头处理，
+ *       本次循环的角度解算已使用新参数，角度发送目标和前向纠错组大小随之切换
+ */
+static void Bluetooth_Handle_Param(uint8_t Type, const void *Body, uint8_t Length, uint32_t Time){
+	MsgParamAck ack;
+	uint8_t target = (uint8_t)Tune.SendTarget;
+	uint8_t ack_length = Param_Handle(&Tune_Table, Type, (const uint8_t *)Body, Length, (uint8_t *)&ack);
+	
+	Tune_Apply();
+	if((uint8_t)Tune.SendTarget != target){
+		AngleCodec_ForceKey(&Angle_Encoder);  // 新目标没有当前关键帧
+	}
+	if(ack_length > 0){
+		Serial_SendMessageTo(Proto_Source(), MSG_PARAM_ACK, &ack, ack_length, 0);
+	}
+}
+
+/**
+ * @brief 接收端请求关键帧
+ * @param Type 消息类型
+ * @param Body 消息体（无）
+ * @param Length 消息体长度
+ * @param Time 接收时间（us）
+ * @retval 无
+ * @note 接收端缺少当前关键帧（链路中断后恢复等）时发出，下一帧立即改发关键帧，
+ *       不必等待ANGLE_KEY_INTERVAL
+ */
+static void Bluetooth_Handle_KeyRequest(uint8_t Type, const void *Body, uint8_t Length, uint32_t Time){
+	AngleCodec_ForceKey(&Angle_Encoder);
+}
+
+/**
+ * @brief 接收端的流控信用
+ * @param Type 消息类型
+ * @param Body CREDIT消息体
+ * @param Length 消息体长度
+ * @param Time 接收时间（us）
+ * @retval 无
+ */
+static void Bluetooth_Handle_Credit(uint8_t Type, const void *Body, uint8_t Length, uint32_t Time){
+	Flow_OnCredit(&Bluetooth_Flow, Proto_Source(), (const MsgCredit *)Body, Time);
+}
+
+/**
+ * @brief 统计报告请求
+ * @param Type 消息类型
+ * @param Body 消息体（保留）
+ * @param Length 消息体长度
+ * @param Time 接收时间（us）
+ * @retval 无
+ * @note 输出角度发送统计和循环监测报告，写入日志缓冲区，由Telemetry_DrainLog从遥测串口发出；
+ *       请求经协议层按目标地址过滤，只有被请求的节点应答
+ */
+static void Bluetooth_Handle_Stat(uint8_t Type, const void *Body, uint8_t Length, uint32_t Time){
+	Bluetooth_Report();
+	Monitor_Report();
+}
+
+/**
+ * @brief 接收端的链路报告
+ * @param Type 消息类型
+ * @param Body LINK_REPORT消息体
+ * @param Length 消息体长度
+ * @param Time 接收时间（us）
+ * @retval 无
+ * @note 同时带上本端流控的累计推迟次数，窗口已满也作为拥塞信号
+ */
+static void Bluetooth_Handle_LinkReport(uint8_t Type, const void *Body, uint8_t Length, uint32_t Time){
+	Rate_OnReport(&Bluetooth_Rate, Proto_Source(), (const MsgLinkReport *)Body, Bluetooth_Flow.Blocked, Time);
+}
+
+/**
+ * @brief 发送端消息分发表
+ * @note 最小长度见Message.h的MSG_LIST
+ */
+static const ProtoEntry Bluetooth_Table[] = {
+	{MSG_PING,        MSG_PING_MIN,      Bluetooth_Reply_Ping},
+	{MSG_PARAM_GET,   MSG_PARAM_GET_MIN, Bluetooth_Handle_Param},
+	{MSG_PARAM_SET,   MSG_PARAM_SET_MIN, Bluetooth_Handle_Param},
+	{MSG_KEY_REQUEST, 0,                 Bluetooth_Handle_KeyRequest},  // 无消息体
+	{MSG_CREDIT,      MSG_CREDIT_MIN,    Bluetooth_Handle_Credit},
+	{MSG_LINK_REPORT, MSG_LINK_REPORT_MIN, Bluetooth_Handle_LinkReport},
+	{MSG_STAT_REQUEST, MSG_STAT_REQUEST_MIN, Bluetooth_Handle_Stat},
+};
+
+/**
+ * @brief 处理接收到的数据包
+ * @param Packet 数据包
+ * @param Length 数据包长度
+ * @param Time 接收时间（us）
+ * @retval 无
+ * @note 按分发表调用各消息的处理函数，不认识的消息跳过
+ */
+void Bluetooth_Receive(const uint8_t *Packet, uint8_t Length, uint32_t Time){
+	Proto_Dispatch(Bluetooth_Table, sizeof(Bluetooth_Table) / sizeof(Bluetooth_Table[0]),
+	               &Bluetooth_RxStats, Packet, Length, Time);
+}
+
+/**
+ * @brief 将滤波后的角度保存到备份寄存器
+ * @param 无
+ * @retval 无
+ * @note 每个主循环调用一次，复位后据此恢复滤波器，接收端舵机不会因滤波器重新初始化而跳变
+ */
+void Filter_SaveState(void){
+	uint16_t state[2];
+	state[0] = (uint16_t)(S1_Filtered * 10);  // 以0.1°精度保存，与角度帧一致
+	state[1] = (uint16_t)(S2_Filtered * 10);
+	Watchdog_SaveState(state, 2);
+}
+
+/**
+ * @brief 热启动时从备份寄存器恢复滤波后的角度
+ * @param 无
+ * @retval 1表示已恢复，0表示冷启动（滤波器需用当前角度初始化）
+ */
+uint8_t Filter_RestoreState(void){
+	uint16_t state[2];
+	if(!Watchdog_LoadState(state, 2)){
+		return 0;
+	}
+	S1_Filtered = (float)state[0] / 10.0f;
+	S2_Filtered = (float)state[1] / 10.0f;
+	return 1;
+}
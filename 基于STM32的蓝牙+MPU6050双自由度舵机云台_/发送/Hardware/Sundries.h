@@ -1,45 +1,136 @@
 #ifndef _SUNDRIES_H
 #define _SUNDRIES_H
 
+#include "Flow.h"
+#include "Rate.h"
+#include "Gimbal.h"  // 倾角范围、舵机范围和主循环间隔，与接收端共用
+
 /**
- * @brief 角度范围定义
- * @note 有效角度范围为±ANGLE_RANGE度
+ * @brief 滤波系数定义
+ * @note FILTER_ALPHA越大，响应越快但滤波效果越差；反之亦然
  */
-#define ANGLE_RANGE 30.0f
+#define FILTER_ALPHA 0.8f
 
 /**
- * @brief 蓝牙通信帧格式定义
+ * @brief 按变化发送角度
+ * @note 任一角度相对上次发出的值变化超过SEND_DEADBAND才发送；静止时每隔SEND_KEEPALIVE
+ *       补发一次关键帧，保证接收端最终收敛到准确角度
  */
-#define ANGLE_FRAME_HEADER 0xFF  // 角度数据帧头标记
-#define ANGLE_FRAME_TAIL 0xFE    // 角度数据帧尾标记
+#define SEND_DEADBAND 0.3f       // 死区（度），0表示每个主循环都发送
+#define SEND_KEEPALIVE 200       // 保活间隔（ms）
 
 /**
- * @brief 舵机1角度范围定义
+ * @brief 批量发送
+ * @note 大于1时每SEND_BATCH个样本合成一条MSG_ANGLE_BATCH消息发送，减少数据包数而不丢失中间的
+ *       运动，接收端按时间戳插值回放（需打开接收端的PLAYOUT_MODE）；为1时每个样本单独发送；
+ *       打开RATE_CONTROL时为每条消息样本数的上限，实际样本数随发送速率调整
  */
-#define SERVO1_MIN 30.0f         // 舵机1最小角度（度）
-#define SERVO1_MAX 150.0f        // 舵机1最大角度（度）
+#define SEND_BATCH 1             // 每条消息的样本数，1~MSG_BATCH_MAX
 
 /**
- * @brief 舵机2角度范围定义
+ * @brief 角度发送目标
+ * @note 一个发送端可驱动多个接收端：目标为某个接收端编号（1~127）时只有该云台跟随，
+ *       为组地址PROTO_ADDR_GROUP(g)（128~135）时该组的云台跟随，为PROTO_ADDR_BROADCAST（255）时全部跟随；
+ *       时延探测和参数命令的应答总是发回请求的接收端
  */
-#define SERVO2_MIN 0.0f          // 舵机2最小角度（度）
-#define SERVO2_MAX 180.0f        // 舵机2最大角度（度）
+#define SEND_TARGET 255          // 目标地址，见Proto.h
 
 /**
- * @brief 滤波系数定义
- * @note FILTER_ALPHA越大，响应越快但滤波效果越差；反之亦然
+ * @brief 前向纠错
+ * @note 每FEC_GROUP个数据包之后插入一个异或校验帧，接收端可就地还原每组中丢失或损坏的一个包，
+ *       不需要重传；带宽增加约1/FEC_GROUP，还原的包最多晚FEC_GROUP个包的时间；0表示关闭
  */
-#define FILTER_ALPHA 0.8f
+#define FEC_GROUP 0              // 每组数据包数，0~FEC_MAX_GROUP
+
+/**
+ * @brief 发送内容
+ * @note SEND_MODE_ANGLE：发送端按ANGLE_RANGE和舵机范围换算出两个舵机角度后发送，两端的范围需一致；
+ *       SEND_MODE_QUAT：发送滤波后的重力方向对应的姿态四元数（压缩为6字节），各接收端按自己的
+ *       倾角范围、舵机范围和轴映射换算，一个发送端可驱动结构不同的云台；此时SEND_BATCH不起作用
+ */
+#define SEND_MODE_ANGLE 0
+#define SEND_MODE_QUAT 1
+#define SEND_MODE SEND_MODE_ANGLE
 
 /**
- * @brief 主循环间隔时间
- * @note 单位：毫秒，需与接收端保持同步
+ * @brief 自适应发送速率
+ * @note 按接收端的链路报告（丢包、CRC错误、溢出）和本端流控做加性增、乘性减（见Rate.h）：
+ *       链路退化时降低发送频率，并在SEND_BATCH允许时把连续几个样本合成一条消息；
+ *       0表示关闭，始终以主循环频率发送
  */
-#define LOOP_INTERVAL 8
+#define RATE_CONTROL 1
+
+/**
+ * @brief 看门狗超时时间
+ * @note 单位：毫秒，需大于统计报告等最长阻塞时间
+ */
+#define WATCHDOG_TIMEOUT 1000
+
+/**
+ * @brief 主循环任务编号及单次执行预算（用于循环耗时监测）
+ * @note 预算单位：微秒，超出预算计为一次超时
+ */
+#define TASK_IMU 0               // 读取MPU6050
+#define TASK_CALC 1              // 角度解算与滤波
+#define TASK_SEND 2              // 蓝牙发送
+#define TASK_OLED 3              // OLED刷新
+#define TASK_IMU_BUDGET 4000
+#define TASK_CALC_BUDGET 500
+#define TASK_SEND_BUDGET 100
+#define TASK_OLED_BUDGET 2000
+
+/**
+ * @brief 可在线调整的参数编号（发送端），上电默认值为上面的宏定义
+ */
+#define PARAM_ANGLE_RANGE 1      // ANGLE_RANGE
+#define PARAM_FILTER_ALPHA 2     // FILTER_ALPHA
+#define PARAM_SERVO1_MIN 3       // SERVO1_MIN
+#define PARAM_SERVO1_MAX 4       // SERVO1_MAX
+#define PARAM_SERVO2_MIN 5       // SERVO2_MIN
+#define PARAM_SERVO2_MAX 6       // SERVO2_MAX
+#define PARAM_SEND_DEADBAND 7    // SEND_DEADBAND
+#define PARAM_SEND_KEEPALIVE 8   // SEND_KEEPALIVE
+#define PARAM_SEND_BATCH 9       // SEND_BATCH
+#define PARAM_SEND_TARGET 10     // SEND_TARGET
+#define PARAM_SEND_MODE 11       // SEND_MODE
+#define PARAM_FEC_GROUP 12       // FEC_GROUP
+#define PARAM_RATE_CONTROL 13    // RATE_CONTROL
+
+/**
+ * @brief 可在线调整的参数
+ */
+typedef struct {
+	float AngleRange;    // 有效倾角范围（±度）
+	float FilterAlpha;   // 低通滤波系数
+	float Servo1Min;     // 舵机1最小角度（度）
+	float Servo1Max;     // 舵机1最大角度（度）
+	float Servo2Min;     // 舵机2最小角度（度）
+	float Servo2Max;     // 舵机2最大角度（度）
+	float SendDeadband;  // 发送死区（度）
+	float SendKeepalive; // 保活间隔（ms）
+	float SendBatch;     // 每条消息的样本数
+	float SendTarget;    // 角度发送目标地址
+	float SendMode;      // 发送内容：角度或四元数
+	float FecGroup;      // 前向纠错每组数据包数
+	float RateControl;   // 自适应发送速率开关
+} TuneParam;
+
+extern TuneParam Tune;
+extern Flow Bluetooth_Flow;  // 信用流控
+extern Rate Bluetooth_Rate;  // 自适应发送速率
 
 /**
  * @brief 函数声明
  */
 void Bluetooth_Send_DualAngle();  // 通过蓝牙发送双角度数据
+void Bluetooth_Send_Quat(float Gx, float Gy, float Gz);  // 通过蓝牙发送姿态四元数
+void Bluetooth_Send_Heartbeat(void);  // 没有角度消息时补发心跳
+void Bluetooth_Report(void);      // 输出发送统计
+void Telemetry_Send_Sample(int16_t Ax, int16_t Ay, int16_t Az);  // 从遥测串口发出原始样本
+void Telemetry_Send_Status(void);  // 按周期从遥测串口发出运行状态
+void Bluetooth_Receive(const uint8_t *Packet, uint8_t Length, uint32_t Time);  // 处理接收到的数据包
+void Tune_Apply(void);            // 把参数同步到通信模块
+void Filter_SaveState(void);      // 保存滤波状态到备份寄存器
+uint8_t Filter_RestoreState(void);  // 热启动时恢复滤波状态
 
 #endif
\ No newline at end of file
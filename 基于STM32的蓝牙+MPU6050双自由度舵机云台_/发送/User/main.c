@@ -6,6 +6,11 @@
 #include "Sundries.h"
 #include "MyI2C.h"
 #include "MPU6050.h"
+#include "Timer.h"
+#include "Monitor.h"
+#include "Watchdog.h"
+#include "HC05.h"
+#include "Telemetry.h"
 #include <math.h>
 
 /**
@@ -29,6 +34,20 @@ int main(void){
 	OLED_Init();        // 初始化OLED显示屏
 	MPU6050_Init();     // 初始化MPU6050传感器
 	Serial_Init();      // 初始化串口通信（蓝牙）
+	Telemetry_Init();   // 初始化遥测串口（USART2，日志、统计和原始样本不再占用蓝牙）
+	Timer_Init();       // 初始化微秒时间基准
+	HC05_Init();        // 初始化HC-05 KEY引脚
+	HC05_Negotiate(HC05_TARGET_BAUD);  // 将蓝牙串口提速到目标波特率
+	Tune_Apply();  // 角度发送目标（SEND_TARGET）、前向纠错（FEC_GROUP）
+	Flow_Init(&Bluetooth_Flow);  // 尚未收到信用，不限流
+	Rate_Init(&Bluetooth_Rate, 1000 / LOOP_INTERVAL);  // 尚未收到链路报告，以主循环频率发送
+	
+	// 初始化循环监测，登记各任务及其预算
+	Monitor_Init(LOOP_INTERVAL * 1000);
+	Monitor_AddTask(TASK_IMU, "IMU", TASK_IMU_BUDGET);
+	Monitor_AddTask(TASK_CALC, "CALC", TASK_CALC_BUDGET);
+	Monitor_AddTask(TASK_SEND, "SEND", TASK_SEND_BUDGET);
+	Monitor_AddTask(TASK_OLED, "OLED", TASK_OLED_BUDGET);
 	
 	// 在OLED上显示初始信息
 	OLED_ShowString(1, 1, "ID:");       // 显示ID标签
@@ -58,18 +77,35 @@ int main(void){
 	ThetaY = atan(AY_g / AZ_g) * 180 / 3.14159;  // 计算Y轴角度
 	
 	// 将角度转换为舵机的PWM值
-	S1_Angle = ((ThetaX + ANGLE_RANGE) / (2 * ANGLE_RANGE)) * (SERVO1_MAX - SERVO1_MIN) + SERVO1_MIN;
-	S2_Angle = ((ThetaY + ANGLE_RANGE) / (2 * ANGLE_RANGE)) * (SERVO2_MAX - SERVO2_MIN) + SERVO2_MIN;
+	S1_Angle = ((ThetaX + Tune.AngleRange) / (2 * Tune.AngleRange)) * (Tune.Servo1Max - Tune.Servo1Min) + Tune.Servo1Min;
+	S2_Angle = ((ThetaY + Tune.AngleRange) / (2 * Tune.AngleRange)) * (Tune.Servo2Max - Tune.Servo2Min) + Tune.Servo2Min;
+	
+	// 初始化滤波后的角度：热启动时沿用复位前的滤波状态，冷启动时取当前角度
+	if(!Filter_RestoreState()){
+		S1_Filtered = S1_Angle;  // 初始滤波值为当前角度
+		S2_Filtered = S2_Angle;
+	}
 	
-	// 初始化滤波后的角度
-	S1_Filtered = S1_Angle;  // 初始滤波值为当前角度
-	S2_Filtered = S2_Angle;
+	// 初始化完成后再启动看门狗，避免初始化期间的延时触发复位
+	Watchdog_Init(WATCHDOG_TIMEOUT);
 	
 	// 主循环
 	while(1){
+		Monitor_LoopBegin();  // 记录循环周期
+		
+		// 按顺序处理接收队列中的数据包：统计请求、时延探测、读/写参数
+		const QueueFrame *RxFrame;
+		while((RxFrame = FrameQueue_Peek(&Serial_RxQueue)) != 0){
+			Bluetooth_Receive(RxFrame->Data, RxFrame->Length, RxFrame->Time);  // 按消息类型分发
+			FrameQueue_Pop(&Serial_RxQueue);
+		}
+		
 		// 读取MPU6050的加速度数据
+		Monitor_TaskBegin(TASK_IMU);
 		MPU6050_GetData(&AX, &AY, &AZ, 0, 0, 0);  // 只读取加速度数据
+		Monitor_TaskEnd(TASK_IMU);
 		
+		Monitor_TaskBegin(TASK_CALC);
 		// 将原始加速度数据转换为单位为g的值
 		AX_g = (float)AX * 32 / 65535;
         AY_g = (float)AY * 32 / 65535;
@@ -85,35 +121,55 @@ int main(void){
 		ThetaY = atan(AY_g / AZ_g) * 180 / 3.14159;
 		
 		// 限制角度范围
-		ThetaX = (ThetaX < -ANGLE_RANGE) ? -ANGLE_RANGE : ((ThetaX > ANGLE_RANGE) ? ANGLE_RANGE : ThetaX);
-		ThetaY = (ThetaY < -ANGLE_RANGE) ? -ANGLE_RANGE : ((ThetaY > ANGLE_RANGE) ? ANGLE_RANGE : ThetaY);
+		ThetaX = (ThetaX < -Tune.AngleRange) ? -Tune.AngleRange : ((ThetaX > Tune.AngleRange) ? Tune.AngleRange : ThetaX);
+		ThetaY = (ThetaY < -Tune.AngleRange) ? -Tune.AngleRange : ((ThetaY > Tune.AngleRange) ? Tune.AngleRange : ThetaY);
 		
 		// 将角度转换为舵机的PWM值
-		S1_Angle = ((ThetaX + ANGLE_RANGE) / (2 * ANGLE_RANGE)) * (SERVO1_MAX - SERVO1_MIN) + SERVO1_MIN;
-        S2_Angle = ((ThetaY + ANGLE_RANGE) / (2 * ANGLE_RANGE)) * (SERVO2_MAX - SERVO2_MIN) + SERVO2_MIN;
+		S1_Angle = ((ThetaX + Tune.AngleRange) / (2 * Tune.AngleRange)) * (Tune.Servo1Max - Tune.Servo1Min) + Tune.Servo1Min;
+        S2_Angle = ((ThetaY + Tune.AngleRange) / (2 * Tune.AngleRange)) * (Tune.Servo2Max - Tune.Servo2Min) + Tune.Servo2Min;
 		
 		// 限制舵机角度范围
-		S1_Angle = (S1_Angle < SERVO1_MIN) ? SERVO1_MIN : (S1_Angle > SERVO1_MAX ? SERVO1_MAX : S1_Angle);
-        S2_Angle = (S2_Angle < SERVO2_MIN) ? SERVO2_MIN : (S2_Angle > SERVO2_MAX ? SERVO2_MAX : S2_Angle);
+		S1_Angle = (S1_Angle < Tune.Servo1Min) ? Tune.Servo1Min : (S1_Angle > Tune.Servo1Max ? Tune.Servo1Max : S1_Angle);
+        S2_Angle = (S2_Angle < Tune.Servo2Min) ? Tune.Servo2Min : (S2_Angle > Tune.Servo2Max ? Tune.Servo2Max : S2_Angle);
 		
 		// 使用一阶低通滤波平滑舵机角度
-		S1_Filtered = S1_Angle * FILTER_ALPHA + S1_Filtered * (1 - FILTER_ALPHA);
-		S2_Filtered = S2_Angle * FILTER_ALPHA + S2_Filtered * (1 - FILTER_ALPHA);
+		S1_Filtered = S1_Angle * Tune.FilterAlpha + S1_Filtered * (1 - Tune.FilterAlpha);
+		S2_Filtered = S2_Angle * Tune.FilterAlpha + S2_Filtered * (1 - Tune.FilterAlpha);
+		Monitor_TaskEnd(TASK_CALC);
 		
-		// 通过蓝牙发送双角度数据
-		Bluetooth_Send_DualAngle();
+		// 通过蓝牙发送姿态：双角度或四元数
+		Monitor_TaskBegin(TASK_SEND);
+		if((uint8_t)Tune.SendMode == SEND_MODE_QUAT){
+			Bluetooth_Send_Quat(AX_g, AY_g, AZ_g);  // 接收端自行换算角度
+		}
+		else{
+			Bluetooth_Send_DualAngle();
+		}
+		Bluetooth_Send_Heartbeat();
+		Monitor_TaskEnd(TASK_SEND);
+		
+		// 遥测串口：原始样本、运行状态和日志
+		Telemetry_Send_Sample(AX, AY, AZ);
+		Telemetry_Send_Status();
+		Telemetry_DrainLog();
 		
 		// 每隔一段时间更新OLED显示（降低显示频率，减少资源占用）
 		static uint8_t showCnt = 0;
 		if(showCnt >= 2){
+			Monitor_TaskBegin(TASK_OLED);
 			OLED_ShowNum(3, 3, (uint16_t)S1_Filtered, 3);  // 显示X轴角度
 			OLED_ShowNum(4, 3, (uint16_t)S2_Filtered, 3);  // 显示Y轴角度
+			Monitor_TaskEnd(TASK_OLED);
 			showCnt = 0;  // 重置计数器
 		}
 		else{
 			showCnt++;  // 计数器递增
 		}
 		
+		// 保存滤波状态并喂狗
+		Filter_SaveState();
+		Watchdog_Feed();
+		
 		Delay_ms(LOOP_INTERVAL);  // 循环间隔延时
 	}
 }
\ No newline at end of file
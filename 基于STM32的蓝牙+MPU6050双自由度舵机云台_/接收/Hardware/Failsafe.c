@@ -0,0 +1,60 @@
+#include "stm32f10x.h"                  // Device header
+#include "Failsafe.h"
+
+/**
+ * @brief 初始化链路超时监测
+ * @param Monitor 监测状态
+ * @param Now 当前时间（us）
+ * @retval 无
+ * @note 上电时视为链路正常，从Now开始计时：热启动后舵机先保持恢复的位置，
+ *       超时仍未收到数据才执行失效保护策略
+ */
+void Failsafe_Init(Failsafe *Monitor, uint32_t Now){
+	Monitor->State = LINK_STATE_OK;
+	Monitor->LastFeed = Now;
+	Monitor->LostTime = Now;
+	Monitor->Losses = 0;
+	Monitor->LastOutage = 0;
+	Monitor->MaxOutage = 0;
+}
+
+/**
+ * @brief 记录一次有效数据
+ * @param Monitor 监测状态
+ * @param Time 数据的接收时间（us）
+ * @retval 无
+ * @note 处于中断状态时立即恢复，下一次舵机控制即跟随新的目标角度；
+ *       接收时间早于已记录时间的数据（同一批次内的旧帧）不回拨计时
+ */
+void Failsafe_Feed(Failsafe *Monitor, uint32_t Time){
+	uint32_t Outage;
+	
+	if((int32_t)(Time - Monitor->LastFeed) > 0){
+		Monitor->LastFeed = Time;
+	}
+	if(Monitor->State == LINK_STATE_LOST){
+		Monitor->State = LINK_STATE_OK;
+		Outage = Time - Monitor->LostTime;
+		Monitor->LastOutage = Outage;
+		if(Outage > Monitor->MaxOutage){
+			Monitor->MaxOutage = Outage;
+		}
+	}
+}
+
+/**
+ * @brief 检查链路是否超时
+ * @param Monitor 监测状态
+ * @param Now 当前时间（us）
+ * @param Timeout 超时时间（us），需大于MSG_HEARTBEAT_INTERVAL
+ * @retval 当前链路状态
+ * @note 每个主循环调用一次
+ */
+uint8_t Failsafe_Update(Failsafe *Monitor, uint32_t Now, uint32_t Timeout){
+	if(Monitor->State == LINK_STATE_OK && Now - Monitor->LastFeed > Timeout){
+		Monitor->State = LINK_STATE_LOST;
+		Monitor->LostTime = Monitor->LastFeed;  // 中断时长从最后一次收到数据算起
+		Monitor->Losses ++;
+	}
+	return Monitor->State;
+}
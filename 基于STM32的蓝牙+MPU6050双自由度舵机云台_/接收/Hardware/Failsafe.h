@@ -0,0 +1,37 @@
+#ifndef __FAILSAFE_H
+#define __FAILSAFE_H
+
+#include <stdint.h>
+
+/**
+ * @brief 链路状态
+ */
+#define LINK_STATE_OK		0			//在超时时间内收到过有效数据
+#define LINK_STATE_LOST		1			//超时未收到有效数据，执行失效保护策略
+
+/**
+ * @brief 链路中断时的失效保护策略
+ */
+#define FAILSAFE_HOLD		0			//保持最后的目标角度
+#define FAILSAFE_HOME		1			//以受控速度回到预设位置
+#define FAILSAFE_LIMP		2			//停止输出PWM脉冲，舵机卸力
+
+/**
+ * @brief 链路超时监测
+ * @note 收到有效角度或心跳时调用Failsafe_Feed，主循环调用Failsafe_Update；
+ *       检测延时不超过超时时间加一个主循环周期
+ */
+typedef struct {
+	uint8_t State;						//LINK_STATE_OK或LINK_STATE_LOST
+	uint32_t LastFeed;					//最近一次收到有效数据的时间（us）
+	uint32_t LostTime;					//最近一次判定中断的时间（us）
+	uint32_t Losses;					//累计中断次数
+	uint32_t LastOutage;				//最近一次中断持续时间（us），恢复时更新
+	uint32_t MaxOutage;					//最长中断持续时间（us）
+} Failsafe;
+
+void Failsafe_Init(Failsafe *Monitor, uint32_t Now);
+void Failsafe_Feed(Failsafe *Monitor, uint32_t Time);
+uint8_t Failsafe_Update(Failsafe *Monitor, uint32_t Now, uint32_t Timeout);
+
+#endif
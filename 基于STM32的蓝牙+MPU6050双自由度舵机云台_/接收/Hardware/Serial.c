@@ -2,27 +2,60 @@
 // Serial.c - 串口通信模块
 // 功能：
 // 1. 初始化串口通信
-// 2. 实现串口中断接收（角度帧接收）
-// 3. 提供串口发送功能
+// 2. 实现串口DMA循环接收（空闲中断分段，主循环中解析角度帧）
+// 3. 提供串口DMA发送功能
 // 作者：
 // 日期：
 // ==================================================================
 #include "stm32f10x.h"                  // STM32F103系列头文件
-#include <stdio.h>                       // 标准输入输出库
-#include <stdarg.h>                      // 可变参数库
+#include <string.h>                      // 内存复制
 
-// 串口发送数据包（预留）
-uint8_t Serial_TxPacket[4];
-
-// 包含Sundries.h以使用FRAME_LENGTH宏定义
+// Serial.h中有发送缓冲区大小和函数声明
 #include "Sundries.h"
-
-// 串口接收缓存区（存储接收到的角度帧数据）
-// 格式：[0xFF][s1_lower][s1_upper][s2_lower][s2_upper][0xFE]
-uint8_t Serial_RxPacket[FRAME_LENGTH];
-
-// 串口接收完成标志位（1: 接收完成，0: 未完成）
-uint8_t Serial_RxFlag;
+#include "Serial.h"
+#include "Timer.h"
+
+// 串口接收帧队列（存储校验通过的数据包，格式见Proto.h）
+// 由Serial_ProcessRx中的解码器生产，主循环消费，帧在发布前已完整写入，不会读到半帧
+FrameQueue Serial_RxQueue;
+
+// 串口接收COBS解码器（仅在Serial_ProcessRx中使用）
+LinkDecoder Serial_RxDecoder;
+
+// 串口接收数据包统计（CRC错误、丢包、重复、乱序及链路质量）
+LinkStats Serial_RxStats;
+
+// 前向纠错：保存最近的数据包，收到校验帧时还原同组丢失的一个包
+FecDecoder Serial_RxFec;
+
+// DMA双缓冲发送：一个缓冲区由DMA1通道4发送时，新数据写入另一个（填充缓冲区），
+// 发送完成中断中交换。Serial_TxSending为正在发送的缓冲区编号，另一个即为填充缓冲区
+#define SERIAL_TX_NO_FRAME 0xFFFF
+#define SERIAL_TX_RAW_FRAME 0x00                           // Serial_SendFrame发出的原始帧的替换类型（不与任何消息类型重复）
+
+static uint8_t Serial_TxBuf[2][SERIAL_TX_BUF_SIZE];        // 发送缓冲区
+static volatile uint16_t Serial_TxLen[2];                  // 各缓冲区待发送字节数
+static volatile uint8_t Serial_TxSending;                  // 正在发送的缓冲区编号
+static volatile uint8_t Serial_TxBusy;                     // DMA发送进行中标志
+static uint16_t Serial_TxFrameStart = SERIAL_TX_NO_FRAME;  // 填充缓冲区末尾那一帧的起始位置，可被新帧覆盖
+static uint8_t Serial_TxSeq;                               // 下一个数据包的序号
+static uint8_t Serial_TxFrameSeq;                          // 填充缓冲区末尾那一帧的序号，替换该帧时沿用
+static uint8_t Serial_TxFrameType;                         // 填充缓冲区末尾那一帧的消息类型，只有同类型的新帧可以替换它
+uint32_t Serial_TxCoalesced;                               // 尚未发出即被新帧替换的帧数
+uint32_t Serial_TxDropped;                                 // 缓冲区满而丢弃的帧数
+
+// DMA循环接收：DMA1通道5把USART1收到的字节连续写入环形缓冲区，
+// 空闲(IDLE)、半满(HT)、全满(TC)中断只记录DMA写到的位置，解析放在主循环的Serial_ProcessRx中
+static uint8_t Serial_RxBuf[SERIAL_RX_BUF_SIZE];           // 接收环形缓冲区
+static volatile uint16_t Serial_RxHead;                    // DMA已写到的位置（中断中更新）
+static volatile uint16_t Serial_RxUnread;                  // 中断已登记、主循环尚未处理的字节数
+static uint16_t Serial_RxTail;                             // 主循环已解析到的位置
+static volatile uint32_t Serial_RxIsrTime;                 // 最近一次登记到新数据的时间（us）
+static uint32_t Serial_RxTime;                             // 本批数据的接收时间，记入解析出的帧
+uint32_t Serial_RxOverflow;                                // 主循环来不及处理、环形缓冲区被覆盖的次数
+uint32_t Serial_RxOverrun;                                 // 溢出错误(ORE)次数
+uint32_t Serial_RxNoise;                                   // 噪声错误(NE)次数
+uint32_t Serial_RxFraming;                                 // 帧错误(FE)次数
 
 // ==================================================================
 // 函数名：Serial_Init
@@ -33,6 +66,11 @@ uint8_t Serial_RxFlag;
 // ==================================================================
 void Serial_Init(void){
 
+	FrameQueue_Init(&Serial_RxQueue);  // 开启接收前初始化接收队列
+	Link_DecoderInit(&Serial_RxDecoder);  // 初始化COBS解码器
+	Link_StatsInit(&Serial_RxStats);      // 清零接收统计
+	Fec_DecoderInit(&Serial_RxFec);       // 清空前向纠错历史
+
 	// 使能串口1和GPIOA时钟
 	RCC_APB2PeriphClockCmd(RCC_APB2Periph_USART1,ENABLE);
 	RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA,ENABLE);
@@ -60,8 +98,44 @@ void Serial_Init(void){
 	USART_InitStructure.USART_WordLength=USART_WordLength_8b;    // 8位数据位
 	USART_Init(USART1,&USART_InitStructure);                     // 应用配置
 	
-	// 使能串口接收中断
-	USART_ITConfig(USART1,USART_IT_RXNE,ENABLE);
+	// 使能串口空闲中断和错误中断（接收数据由DMA搬运，不再开启RXNE中断）
+	USART_ITConfig(USART1,USART_IT_IDLE,ENABLE);
+	USART_ITConfig(USART1,USART_IT_ERR,ENABLE);
+	
+	// 配置DMA1通道5（USART1_RX）：外设到内存，循环模式
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1,ENABLE);
+	DMA_InitTypeDef DMA_InitStructure;
+	DMA_InitStructure.DMA_PeripheralBaseAddr=(uint32_t)&USART1->DR;        // 外设地址：USART1数据寄存器
+	DMA_InitStructure.DMA_PeripheralDataSize=DMA_PeripheralDataSize_Byte;
+	DMA_InitStructure.DMA_PeripheralInc=DMA_PeripheralInc_Disable;
+	DMA_InitStructure.DMA_MemoryBaseAddr=(uint32_t)Serial_RxBuf;
+	DMA_InitStructure.DMA_MemoryDataSize=DMA_MemoryDataSize_Byte;
+	DMA_InitStructure.DMA_MemoryInc=DMA_MemoryInc_Enable;
+	DMA_InitStructure.DMA_DIR=DMA_DIR_PeripheralSRC;                       // 外设到内存
+	DMA_InitStructure.DMA_BufferSize=SERIAL_RX_BUF_SIZE;
+	DMA_InitStructure.DMA_Mode=DMA_Mode_Circular;                          // 循环模式，写满后回到开头
+	DMA_InitStructure.DMA_M2M=DMA_M2M_Disable;
+	DMA_InitStructure.DMA_Priority=DMA_Priority_High;                      // 接收优先于发送，避免丢字节
+	DMA_Init(DMA1_Channel5,&DMA_InitStructure);
+	DMA_ITConfig(DMA1_Channel5,DMA_IT_HT|DMA_IT_TC,ENABLE);               // 半满、全满中断
+	DMA_Cmd(DMA1_Channel5,ENABLE);
+	USART_DMACmd(USART1,USART_DMAReq_Rx,ENABLE);                           // USART1接收请求交给DMA
+	
+	// 配置DMA1通道4（USART1_TX）：内存到外设，每次发送前再设置地址和长度
+	DMA_InitStructure.DMA_PeripheralBaseAddr=(uint32_t)&USART1->DR;        // 外设地址：USART1数据寄存器
+	DMA_InitStructure.DMA_PeripheralDataSize=DMA_PeripheralDataSize_Byte;
+	DMA_InitStructure.DMA_PeripheralInc=DMA_PeripheralInc_Disable;
+	DMA_InitStructure.DMA_MemoryBaseAddr=(uint32_t)Serial_TxBuf[0];
+	DMA_InitStructure.DMA_MemoryDataSize=DMA_MemoryDataSize_Byte;
+	DMA_InitStructure.DMA_MemoryInc=DMA_MemoryInc_Enable;
+	DMA_InitStructure.DMA_DIR=DMA_DIR_PeripheralDST;                       // 内存到外设
+	DMA_InitStructure.DMA_BufferSize=SERIAL_TX_BUF_SIZE;
+	DMA_InitStructure.DMA_Mode=DMA_Mode_Normal;
+	DMA_InitStructure.DMA_M2M=DMA_M2M_Disable;
+	DMA_InitStructure.DMA_Priority=DMA_Priority_Medium;
+	DMA_Init(DMA1_Channel4,&DMA_InitStructure);
+	DMA_ITConfig(DMA1_Channel4,DMA_IT_TC,ENABLE);                          // 开启传输完成中断
+	USART_DMACmd(USART1,USART_DMAReq_Tx,ENABLE);                           // USART1发送请求交给DMA
 	
 	// 配置中断优先级分组
 	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_2);
@@ -74,35 +148,244 @@ void Serial_Init(void){
 	NVIC_InitStructure.NVIC_IRQChannelSubPriority=1;          // 子优先级1
 	NVIC_Init(&NVIC_InitStructure);                           // 应用配置
 	
+	// 配置DMA1通道5中断（接收半满/全满）
+	NVIC_InitStructure.NVIC_IRQChannel=DMA1_Channel5_IRQn;   // DMA1通道5中断通道
+	NVIC_Init(&NVIC_InitStructure);                           // 应用配置（优先级同USART1）
+	
+	// 配置DMA1通道4中断
+	NVIC_InitStructure.NVIC_IRQChannel=DMA1_Channel4_IRQn;   // DMA1通道4中断通道
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority=2;          // 子优先级2
+	NVIC_Init(&NVIC_InitStructure);                           // 应用配置
+	
 	// 使能串口1
 	USART_Cmd(USART1,ENABLE);
 }
 
+// ==================================================================
+// 函数名：Serial_SetBaudRate
+// 功能：修改USART1波特率
+// 参数：BaudRate - 新的波特率
+// 返回值：无
+// 说明：先等待发送缓冲区清空，避免正在发送的数据以错误速率发出
+// ==================================================================
+void Serial_SetBaudRate(uint32_t BaudRate){
+
+	Serial_Flush();
+	USART_Cmd(USART1,DISABLE);
+
+	USART_InitTypeDef USART_InitStructure;
+	USART_InitStructure.USART_BaudRate=BaudRate;
+	USART_InitStructure.USART_HardwareFlowControl=USART_HardwareFlowControl_None;
+	USART_InitStructure.USART_Mode=USART_Mode_Tx|USART_Mode_Rx;
+	USART_InitStructure.USART_Parity=USART_Parity_No;
+	USART_InitStructure.USART_StopBits=USART_StopBits_1;
+	USART_InitStructure.USART_WordLength=USART_WordLength_8b;
+	USART_Init(USART1,&USART_InitStructure);
+
+	USART_Cmd(USART1,ENABLE);
+
+}
+
+// ==================================================================
+// 函数名：Serial_TxStart
+// 功能：启动DMA发送指定缓冲区
+// 参数：Index - 缓冲区编号
+// 返回值：无
+// 说明：需在关中断或DMA中断中调用
+// ==================================================================
+static void Serial_TxStart(uint8_t Index){
+
+	Serial_TxSending=Index;
+	Serial_TxBusy=1;
+	Serial_TxFrameStart=SERIAL_TX_NO_FRAME;  // 新的填充缓冲区中还没有帧
+	DMA_Cmd(DMA1_Channel4,DISABLE);          // 修改地址和长度前需先关闭通道
+	DMA1_Channel4->CMAR=(uint32_t)Serial_TxBuf[Index];
+	DMA_SetCurrDataCounter(DMA1_Channel4,Serial_TxLen[Index]);
+	DMA_Cmd(DMA1_Channel4,ENABLE);
+
+}
+
 void Serial_SendByte(uint8_t Byte){
 
-	USART_SendData(USART1,Byte);
-	while (USART_GetFlagStatus(USART1,USART_FLAG_TXE) == RESET);
+	Serial_SendArray(&Byte,1);
 
 }
 
+// ==================================================================
+// 函数名：Serial_SendArray
+// 功能：发送一个数组
+// 参数：Array - 数组指针，Length - 数组长度
+// 返回值：无
+// 说明：数据复制到填充缓冲区后立即返回，由DMA在后台发送；
+//       只有填充缓冲区写满时才等待正在进行的发送完成
+// ==================================================================
 void Serial_SendArray(uint8_t *Array,uint16_t Length){
 
-	uint16_t i;
-	for(i=0;i<Length;i++){
-		Serial_SendByte(Array[i]);
+	uint8_t Fill;
+	uint16_t Count;
+
+	while(Length>0){
+		__disable_irq();
+		Fill=1-Serial_TxSending;  // 填充缓冲区
+		Count=SERIAL_TX_BUF_SIZE-Serial_TxLen[Fill];
+		if(Count>Length){
+			Count=Length;
+		}
+		memcpy(&Serial_TxBuf[Fill][Serial_TxLen[Fill]],Array,Count);  // 追加到填充缓冲区
+		Serial_TxLen[Fill]+=Count;
+		Serial_TxFrameStart=SERIAL_TX_NO_FRAME;  // 帧之后追加了普通数据，该帧不再可替换
+		if(!Serial_TxBusy && Serial_TxLen[Fill]>0){
+			Serial_TxStart(Fill);  // DMA空闲则立即开始发送
+		}
+		__enable_irq();
+
+		Array+=Count;
+		Length-=Count;
+		if(Length>0){
+			while(Serial_TxLen[1-Serial_TxSending]>=SERIAL_TX_BUF_SIZE);  // 填充缓冲区已满，等待DMA交换缓冲区
+		}
 	}
 
 }
 
-void Serial_SendString(char *String){
+// ==================================================================
+// 函数名：Serial_TxPutFrame
+// 功能：把一帧写入填充缓冲区，尚未发出的旧帧被新帧替换
+// 参数：Array - 帧数据指针，Length - 帧长度（不超过SERIAL_TX_BUF_SIZE）
+// 返回值：无
+// 说明：需在关中断时调用
+// ==================================================================
+static void Serial_TxPutFrame(uint8_t *Array,uint16_t Length){
 
-	uint8_t i;
-	for(i=0;String[i] != '\0';i++){
-		Serial_SendByte(String[i]);
+	uint8_t Fill=1-Serial_TxSending;
+
+	if(Serial_TxFrameStart!=SERIAL_TX_NO_FRAME){
+		Serial_TxLen[Fill]=Serial_TxFrameStart;  // 丢弃末尾尚未发出的旧帧
+		Serial_TxCoalesced++;
+	}
+	if(Serial_TxLen[Fill]+Length<=SERIAL_TX_BUF_SIZE){
+		Serial_TxFrameStart=Serial_TxLen[Fill];
+		memcpy(&Serial_TxBuf[Fill][Serial_TxLen[Fill]],Array,Length);
+		Serial_TxLen[Fill]+=Length;
+		if(!Serial_TxBusy){
+			Serial_TxStart(Fill);
+		}
+	}
+	else{
+		Serial_TxFrameStart=SERIAL_TX_NO_FRAME;
+		Serial_TxDropped++;  // 缓冲区被其他数据占满，丢弃本帧
+	}
+
+}
+
+// ==================================================================
+// 函数名：Serial_SendFrame
+// 功能：发送一帧数据，尚未发出的旧帧被新帧替换
+// 参数：Array - 帧数据指针，Length - 帧长度（不超过SERIAL_TX_BUF_SIZE）
+// 返回值：无
+// 说明：若填充缓冲区末尾是上一个原始帧且还没轮到发送，直接用新帧覆盖；末尾是数据包时追加在其后。不会阻塞
+// ==================================================================
+void Serial_SendFrame(uint8_t *Array,uint16_t Length){
+
+	__disable_irq();
+	if(Serial_TxFrameType!=SERIAL_TX_RAW_FRAME){
+		Serial_TxFrameStart=SERIAL_TX_NO_FRAME;
+	}
+	Serial_TxPutFrame(Array,Length);
+	Serial_TxFrameType=SERIAL_TX_RAW_FRAME;
+	__enable_irq();
+
+}
+
+// ==================================================================
+// 函数名：Serial_SendLink
+// 功能：以带序号和CRC的数据包发送数据，尚未发出的同类型旧包被新包替换
+// 参数：Data - 数据，Length - 数据长度（不超过LINK_MAX_DATA），Type - 消息类型（只有同类型的包才互相替换）
+//       Replaceable - 1表示本包在发出前可被下一个同类型的包替换，0表示本包必须发出
+// 返回值：无
+// 说明：替换旧包时沿用旧包的序号，对端不会把被替换的包计为丢失；类型不同时旧包保留，
+//       新包用新序号追加在其后，例如PING不会覆盖等待中的流控信用
+// ==================================================================
+void Serial_SendLink(const uint8_t *Data,uint8_t Length,uint8_t Type,uint8_t Replaceable){
+
+	uint8_t Buf[LINK_MAX_ENCODED];
+
+	__disable_irq();
+	if(Serial_TxFrameType!=Type){
+		Serial_TxFrameStart=SERIAL_TX_NO_FRAME;  // 等待中的包类型不同，保留并追加在其后
+	}
+	if(Serial_TxFrameStart==SERIAL_TX_NO_FRAME){
+		Serial_TxFrameSeq=Serial_TxSeq++;
+	}
+	Serial_TxPutFrame(Buf,Link_Pack(Serial_TxFrameSeq,Data,Length,Buf));
+	Serial_TxFrameType=Type;
+	if(!Replaceable){
+		Serial_TxFrameStart=SERIAL_TX_NO_FRAME;  // 之后的包追加在其后
+	}
+	__enable_irq();
+
+}
+
+// ==================================================================
+// 函数名：Serial_SendMessage
+// 功能：发送一条协议消息
+// 参数：Type - 消息类型，Body - 消息体，Length - 消息体长度（不超过PROTO_MAX_BODY）
+//       Replaceable - 1表示发出前可被下一个包替换，0表示必须发出
+// 返回值：无
+// 说明：数据包格式见Proto.h，经Serial_SendLink加序号和CRC后发送
+// ==================================================================
+void Serial_SendMessage(uint8_t Type,const void *Body,uint8_t Length,uint8_t Replaceable){
+
+	uint8_t Packet[LINK_MAX_DATA];
+	uint8_t Size=Proto_Begin(Packet);
+
+	Size=Proto_Add(Packet,Size,Type,Body,Length);
+	Serial_SendLink(Packet,Size,Type,Replaceable);
+
+}
+
+// ==================================================================
+// 函数名：Serial_Flush
+// 功能：等待所有数据发送完毕（修改波特率前调用）
+// 参数：无
+// 返回值：无
+// ==================================================================
+void Serial_Flush(void){
+
+	while(Serial_TxBusy);                                       // 等待DMA搬运完成
+	while(USART_GetFlagStatus(USART1,USART_FLAG_TC)==RESET);    // 等待最后一个字节移出
+
+}
+
+// ==================================================================
+// 函数名：DMA1_Channel4_IRQHandler
+// 功能：DMA1通道4中断服务函数（USART1发送完成）
+// 参数：无
+// 返回值：无
+// 说明：当前缓冲区发送完毕后，若填充缓冲区有数据则交换并继续发送
+// ==================================================================
+void DMA1_Channel4_IRQHandler(void){
+
+	if(DMA_GetITStatus(DMA1_IT_TC4)==SET){
+		uint8_t Next=1-Serial_TxSending;
+		Serial_TxLen[Serial_TxSending]=0;  // 当前缓冲区已发完，变为填充缓冲区
+		if(Serial_TxLen[Next]>0){
+			Serial_TxStart(Next);
+		}
+		else{
+			Serial_TxBusy=0;  // 两个缓冲区都已空，下次写入时重新启动
+		}
+		DMA_ClearITPendingBit(DMA1_IT_TC4);
 	}
 
 }
 
+void Serial_SendString(char *String){
+
+	Serial_SendArray((uint8_t *)String,strlen(String));  // 整串写入发送缓冲区
+
+}
+
 uint32_t Serial_Pow(uint32_t X,uint32_t Y){
 
 	uint32_t Result = 1;
@@ -121,82 +404,163 @@ void Serial_SendNumber(uint32_t Number,uint8_t Length){
 
 }
 
-int fputc(int ch,FILE *f){
+// ==================================================================
+// 函数名：Serial_RxUpdate
+// 功能：登记DMA新写入的字节（在中断中调用）
+// 参数：无
+// 返回值：无
+// 说明：HT/TC中断保证每半个缓冲区至少登记一次，两次登记之间的增量不会超过一圈；
+//       累计未处理字节超过缓冲区大小说明主循环被DMA套圈，记一次溢出
+// ==================================================================
+static void Serial_RxUpdate(void){
+
+	uint16_t Head=(SERIAL_RX_BUF_SIZE-DMA_GetCurrDataCounter(DMA1_Channel5))&(SERIAL_RX_BUF_SIZE-1);
+	Serial_RxUnread+=(Head-Serial_RxHead)&(SERIAL_RX_BUF_SIZE-1);
+	Serial_RxHead=Head;
 
-	Serial_SendByte(ch);
-	return ch;
 }
 
-void Serial_Printf(char *format,...){
-
-	char String[100];
-	va_list arg;
-	va_start(arg,format);
-	vsprintf(String,format,arg);
-	va_end(arg);
-	Serial_SendString(String);
-} 
+// ==================================================================
+// 函数名：Serial_ParseByte
+// 功能：逐字节COBS解码，校验通过的数据入队
+// 参数：RxData - 接收到的字节
+// 返回值：无
+// 说明：数据格式：COBS编码的[序号 + 数据 + CRC-16] + 0x00定界符；载荷取任何值都不会被误认为帧边界，
+//       丢字节只损坏当前帧，下一个定界符处即恢复同步；CRC错误、重复或迟到的包被丢弃，
+//       误码不会进入舵机目标角度；队列满时本帧丢弃并计入溢出；
+//       校验帧（发送端打开前向纠错时）用于还原同组中丢失或CRC错误的一个包，还原的包同样入队
+// ==================================================================
+static void Serial_ParseByte(uint8_t RxData){
 
-void Serial_SendPacket(void){
+	uint8_t Repaired[LINK_MAX_DATA];
+	uint8_t *Frame=Serial_RxDecoder.Data;
+	uint8_t Length=Link_Decode(&Serial_RxDecoder,RxData);
+	uint8_t Size;
 
-	Serial_SendByte(0xFF);
-	Serial_SendArray(Serial_TxPacket,4);
-	Serial_SendByte(0xFE);
+	if(Length==0){
+		return;
+	}
+	Size=Link_Check(&Serial_RxStats,Frame,Length);   // 校验CRC和序号
+	if(Size>0){
+		Fec_Store(&Serial_RxFec,Frame[0],&Frame[1],Size);
+		FrameQueue_Push(&Serial_RxQueue,&Frame[1],Size,Serial_RxTime);
+	}
+	else if(Link_IsParity(Frame,Length)){
+		Size=Fec_Repair(&Serial_RxFec,Frame,Length,Repaired);
+		if(Size>0){
+			FrameQueue_Push(&Serial_RxQueue,Repaired,Size,Serial_RxTime);
+		}
+	}
 
 }
 
-uint8_t Serial_GetRxFlag(void){
+// ==================================================================
+// 函数名：Serial_ProcessRx
+// 功能：解析中断登记的接收数据（在主循环中调用）
+// 参数：无
+// 返回值：无
+// 说明：取出自上次调用以来DMA写入的一段字节交给帧状态机；
+//       若缓冲区已被套圈，丢弃全部未处理数据并复位状态机
+// ==================================================================
+void Serial_ProcessRx(void){
+
+	uint16_t Head;
+	uint16_t Count;
+
+	__disable_irq();
+	Count=Serial_RxUnread;
+	Serial_RxUpdate();               // 顺带登记尚未触发空闲中断的字节
+	if(Serial_RxUnread!=Count){
+		Serial_RxIsrTime=Timer_GetMicros();
+	}
+	Head=Serial_RxHead;
+	Count=Serial_RxUnread;
+	Serial_RxUnread=0;
+	Serial_RxTime=Serial_RxIsrTime;  // 本批帧共用最后一段数据的到达时间，误差不超过一批数据的接收时长
+	__enable_irq();
+
+	if(Count>=SERIAL_RX_BUF_SIZE){   // 被套圈：旧数据已被覆盖
+		Serial_RxOverflow++;
+		Serial_RxTail=Head;
+		Link_DecoderResync(&Serial_RxDecoder);   // 丢弃残帧，等待下一个定界符
+		return;
+	}
 
-	if(Serial_RxFlag == 1){
-		Serial_RxFlag=0;
-		return 1;
+	while(Serial_RxTail!=Head){
+		Serial_ParseByte(Serial_RxBuf[Serial_RxTail]);
+		Serial_RxTail=(Serial_RxTail+1)&(SERIAL_RX_BUF_SIZE-1);
 	}
-	return 0;
+
+}
+
+// ==================================================================
+// 函数名：Serial_RxSuspend / Serial_RxResume
+// 功能：暂停/恢复DMA接收，供HC05模块直接查询收发AT指令
+// 参数：无
+// 返回值：无
+// 说明：恢复时丢弃暂停前未处理的数据，解码器等待下一个定界符重新同步
+// ==================================================================
+void Serial_RxSuspend(void){
+
+	USART_DMACmd(USART1,USART_DMAReq_Rx,DISABLE);
+
 }
 
+void Serial_RxResume(void){
+
+	__disable_irq();
+	DMA_Cmd(DMA1_Channel5,DISABLE);
+	DMA_SetCurrDataCounter(DMA1_Channel5,SERIAL_RX_BUF_SIZE);   // 从缓冲区开头重新接收
+	DMA_ClearITPendingBit(DMA1_IT_GL5);
+	DMA_Cmd(DMA1_Channel5,ENABLE);
+	Serial_RxHead=0;
+	Serial_RxUnread=0;
+	Serial_RxTail=0;
+	Link_DecoderResync(&Serial_RxDecoder);
+	__enable_irq();
+	USART_ReceiveData(USART1);                                  // 读DR清除RXNE及错误标志
+	USART_DMACmd(USART1,USART_DMAReq_Rx,ENABLE);
+
+}
 
 // ==================================================================
 // 函数名：USART1_IRQHandler
 // 功能：USART1串口中断服务函数
 // 参数：无
 // 返回值：无
-// 说明：实现串口接收状态机，接收6字节角度帧数据
-// 数据格式：[0xFF][s1_lower][s1_upper][s2_lower][s2_upper][0xFE]
+// 说明：空闲中断表示一段数据接收结束，登记DMA写入位置；
+//       ORE/NE/FE错误计数后读SR再读DR清除，否则ORE会使接收停滞
 // ==================================================================
 void USART1_IRQHandler(void){
 
-	static uint8_t RxState=0;     // 接收状态机状态（0:等待帧头, 1:接收数据, 2:等待帧尾）
-	static uint8_t pRxPacket=0;   // 接收数据计数指针
-		
-	// 检查是否为接收中断
-	if(USART_GetITStatus(USART1,USART_IT_RXNE) == SET){
-
-		uint8_t RxData = USART_ReceiveData(USART1);  // 读取接收到的数据
-		
-		// 状态0：等待帧头0xFF
-		if(RxState==0){
-			if(RxData==0xFF){
-				RxState=1;        // 收到帧头，进入状态1
-				pRxPacket=0;      // 重置接收指针
-			}
-		}
-		// 状态1：接收数据字节（共4字节角度数据）
-		else if(RxState==1){
-			Serial_RxPacket[pRxPacket]=RxData;  // 存储接收到的数据
-			pRxPacket++;                        // 指针递增
-			if(pRxPacket>=4){                   // 接收4字节后进入状态2
-				RxState=2;
-			}
-		}
-		// 状态2：等待帧尾0xFE
-		else if(RxState==2){
-			if(RxData==0xFE){
-				RxState=0;            // 收到帧尾，回到状态0
-				Serial_RxFlag=1;      // 设置接收完成标志
-			}
-		}
-		
-		USART_ClearITPendingBit(USART1,USART_IT_RXNE);  // 清除中断标志位
+	uint16_t Status=USART1->SR;     // 先读SR，随后读DR即可清除IDLE和错误标志
+
+	if(Status&(USART_FLAG_IDLE|USART_FLAG_ORE|USART_FLAG_NE|USART_FLAG_FE)){
+
+		if(Status&USART_FLAG_ORE){Serial_RxOverrun++;}
+		if(Status&USART_FLAG_NE){Serial_RxNoise++;}
+		if(Status&USART_FLAG_FE){Serial_RxFraming++;}
+
+		USART_ReceiveData(USART1);  // 读DR完成清除序列
+		Serial_RxUpdate();
+		Serial_RxIsrTime=Timer_GetMicros();  // 本段数据的到达时间
+	}
+
+}
+
+// ==================================================================
+// 函数名：DMA1_Channel5_IRQHandler
+// 功能：DMA1通道5中断服务函数（接收缓冲区半满/全满）
+// 参数：无
+// 返回值：无
+// 说明：连续接收时没有空闲中断，半满/全满中断保证及时登记
+// ==================================================================
+void DMA1_Channel5_IRQHandler(void){
+
+	if(DMA_GetITStatus(DMA1_IT_HT5)==SET || DMA_GetITStatus(DMA1_IT_TC5)==SET){
+		DMA_ClearITPendingBit(DMA1_IT_HT5|DMA1_IT_TC5);
+		Serial_RxUpdate();
+		Serial_RxIsrTime=Timer_GetMicros();
 	}
 
-}
\ No newline at end of file
+}
@@ -1,24 +1,42 @@
 #ifndef _SERIAL_H
 #define _SERIAL_H
 
-#include <stdio.h>
 #include "Sundries.h"
+#include "FrameQueue.h"
+#include "Link.h"
+#include "Proto.h"
+#include "Fec.h"
 
-extern uint8_t Serial_TxPacket[];
-extern uint8_t Serial_RxPacket[FRAME_LENGTH];
-extern uint8_t Serial_RxFlag;
+#define SERIAL_TX_BUF_SIZE 128  // DMA发送缓冲区大小（双缓冲，每个缓冲区的字节数）
+#define SERIAL_RX_BUF_SIZE 256  // DMA接收环形缓冲区大小，必须为2的幂，需容纳一个主循环周期内收到的数据
+
+extern FrameQueue Serial_RxQueue;
+extern LinkDecoder Serial_RxDecoder;
+extern LinkStats Serial_RxStats;
+extern FecDecoder Serial_RxFec;
+extern uint32_t Serial_TxCoalesced;
+extern uint32_t Serial_TxDropped;
+extern uint32_t Serial_RxOverflow;
+extern uint32_t Serial_RxOverrun;
+extern uint32_t Serial_RxNoise;
+extern uint32_t Serial_RxFraming;
 
 void Serial_Init(void);
+void Serial_SetBaudRate(uint32_t BaudRate);
 void Serial_SendByte(uint8_t Byte);
 void Serial_SendArray(uint8_t *Array,uint16_t Length);
+void Serial_SendFrame(uint8_t *Array,uint16_t Length);
+void Serial_SendLink(const uint8_t *Data,uint8_t Length,uint8_t Type,uint8_t Replaceable);
+void Serial_SendMessage(uint8_t Type,const void *Body,uint8_t Length,uint8_t Replaceable);
+void Serial_Flush(void);
 void Serial_SendString(char *String);
 uint32_t Serial_Pow(uint32_t X,uint32_t Y);
 void Serial_SendNumber(uint32_t Number,uint8_t Length);
-void Serial_Printf(char *format,...);
 
-void Serial_SendPacket(void);
 
-uint8_t Serial_GetRxFlag(void);
+void Serial_ProcessRx(void);
+void Serial_RxSuspend(void);
+void Serial_RxResume(void);
 
 
 #endif
@@ -19,4 +19,10 @@ void Servo_SetAngle2(float Angle2)
 {
 	PWM_SetCompare2(Angle2 / 180 * 2000 + 500);	//设置占空比
 												//将角度线性变换，对应到舵机要求的占空比范围上
+}
+
+void Servo_Release(void)
+{
+	PWM_SetCompare1(0);							//CCR为0时不再输出脉冲，舵机失去位置指令而卸力
+	PWM_SetCompare2(0);							//下一次Servo_SetAngle即恢复输出
 }
\ No newline at end of file
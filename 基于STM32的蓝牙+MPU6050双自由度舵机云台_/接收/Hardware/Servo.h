@@ -4,4 +4,5 @@
 void Servo_Init(void);
 void Servo_SetAngle1(float Angle);
 void Servo_SetAngle2(float Angle);
+void Servo_Release(void);
 #endif
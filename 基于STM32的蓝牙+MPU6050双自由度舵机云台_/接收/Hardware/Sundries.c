@@ -13,6 +13,13 @@
 #include "PWM.h"                       // PWM控制库
 #include "Servo.h"                      // 舵机控制库
 #include "Serial.h"                     // 串口通信库
+#include "Watchdog.h"                   // 看门狗与备份寄存器
+#include "Timer.h"                      // 微秒时间基准
+#include "Message.h"                    // 链路消息类型
+#include "Proto.h"                      // 消息打包与分发
+#include "Log.h"                        // 二进制日志
+#include "Telemetry.h"                  // 遥测串口
+#include "Monitor.h"                    // 循环耗时监测
 
 /* typedef struct {
     float target;       // 目标角度（从发送端解析得到）
@@ -26,36 +33,587 @@
 ServoState servo1 = {90.0f,90.0f,SERVO1_MIN,SERVO1_MAX};  // 舵机1状态：目标90°，当前90°
 ServoState servo2 = {90.0f,90.0f,SERVO2_MIN,SERVO2_MAX};  // 舵机2状态：目标90°，当前90°
 
+// 角度解码器（保存最近的关键帧，差分帧相对它解码）
+AngleDecoder Angle_Decoder;
+
+// 链路时延测量（往返时延、时钟偏差、帧龄直方图）
+Latency Link_Latency;
+
+// 消息分发统计（版本不符、未知类型、格式错误）
+ProtoStats Bluetooth_RxStats;
+
+// 链路超时监测（失效保护）
+Failsafe Link_Failsafe;
+
+// 角度样本回放（按发送端时间戳插值）
+Playout Angle_Playout;
+
+// 流控信用通告（上次通告的序号和时间）
+static FlowAdvert Link_Advert;
+
+// 链路报告（上次报告的时间），发送端据此调整发送速率
+static RateAdvert Link_RateAdvert;
+
+// 平滑控制参数（可在线调整，上电为Sundries.h中的默认值）
+TuneParam tune = {SMALL_ANGLE,LARGE_ANGLE,SMALL_STEP,LARGE_STEP,
+                  FAILSAFE_TIMEOUT,FAILSAFE_POLICY,HOME_SPEED,HOME_ANGLE1,HOME_ANGLE2,
+                  PLAYOUT_MODE,PLAYOUT_DELAY,PLAYOUT_ADAPT,
+                  NODE_ID,NODE_GROUPS,AXIS_MAP1,AXIS_MAP2,FLOW_WINDOW,ANGLE_RANGE};
 
 // ==================================================================
-// 函数名：Parse_DualAngle
-// 功能：解析从发送端接收的双舵机角度数据帧
+// 函数名：Tune_Check
+// 功能：参数组合校验
+// 参数：无
+// 返回值：1 - 合理，0 - 不合理
+// 说明：阈值和步长需小的不大于大的（阈值严格小于，避免插值除零），舵机最小角度小于最大角度，
+//       链路超时大于心跳间隔
+// ==================================================================
+static uint8_t Tune_Check(void){
+
+    return tune.smallAngle<tune.largeAngle && tune.smallStep<=tune.largeStep &&
+           servo1.min<servo1.max && servo2.min<servo2.max &&
+           tune.failTimeout*1000.0f>MSG_HEARTBEAT_INTERVAL;
+
+}
+
+// 接收端参数表
+static const ParamDef Tune_Def[]={
+    {PARAM_SMALL_ANGLE,&tune.smallAngle,0.0f,90.0f},
+    {PARAM_LARGE_ANGLE,&tune.largeAngle,0.0f,180.0f},
+    {PARAM_SMALL_STEP,&tune.smallStep,0.01f,30.0f},
+    {PARAM_LARGE_STEP,&tune.largeStep,0.01f,30.0f},
+    {PARAM_SERVO1_MIN,&servo1.min,0.0f,180.0f},
+    {PARAM_SERVO1_MAX,&servo1.max,0.0f,180.0f},
+    {PARAM_SERVO2_MIN,&servo2.min,0.0f,180.0f},
+    {PARAM_SERVO2_MAX,&servo2.max,0.0f,180.0f},
+    {PARAM_FAILSAFE_TIMEOUT,&tune.failTimeout,3.0f*LOOP_INTERVAL,5000.0f},
+    {PARAM_FAILSAFE_POLICY,&tune.failPolicy,FAILSAFE_HOLD,FAILSAFE_LIMP},
+    {PARAM_HOME_SPEED,&tune.homeSpeed,1.0f,720.0f},
+    {PARAM_HOME_ANGLE1,&tune.home1,0.0f,180.0f},
+    {PARAM_HOME_ANGLE2,&tune.home2,0.0f,180.0f},
+    {PARAM_PLAYOUT_MODE,&tune.playMode,PLAYOUT_OFF,PLAYOUT_HERMITE},
+    {PARAM_PLAYOUT_DELAY,&tune.playDelay,0.0f,(PLAYOUT_SIZE-2)*LOOP_INTERVAL},
+    {PARAM_PLAYOUT_ADAPT,&tune.playAdapt,0.0f,1.0f},
+    {PARAM_NODE_ID,&tune.nodeId,1.0f,PROTO_ADDR_NODE_MAX},
+    {PARAM_NODE_GROUPS,&tune.nodeGroups,0.0f,(1<<PROTO_GROUPS)-1},
+    {PARAM_AXIS_MAP1,&tune.axis1,-2.0f,2.0f},
+    {PARAM_AXIS_MAP2,&tune.axis2,-2.0f,2.0f},
+    {PARAM_FLOW_WINDOW,&tune.flowWindow,0.0f,64.0f},
+    {PARAM_ANGLE_RANGE,&tune.angleRange,1.0f,90.0f},
+};
+static const ParamTable Tune_Table={PARAM_DEST_RECEIVER,Tune_Def,sizeof(Tune_Def)/sizeof(Tune_Def[0]),Tune_Check};
+
+
+// ==================================================================
+// 函数名：Bluetooth_Request_Key
+// 功能：请求发送端立即发送关键帧
 // 参数：无
 // 返回值：无
-// 说明：将接收到的16位角度数据转换为浮点数角度值（0.1°精度）
+// 说明：差分帧缺少关键帧或链路恢复时调用，不必等待下一个周期关键帧（最长约200ms）；
+//       间隔KEY_REQUEST_INTERVAL以内只发一次，请求丢失时由后续差分帧再次触发
+// ==================================================================
+static void Bluetooth_Request_Key(void){
+
+    static uint32_t lastRequest=0;
+    uint32_t now=Timer_GetMicros();
+
+    if(now-lastRequest<KEY_REQUEST_INTERVAL*1000UL){
+        return;
+    }
+    lastRequest=now;
+    Serial_SendMessage(MSG_KEY_REQUEST,"",0,0);  // 无消息体
+
+}
+
+// ==================================================================
+// 函数名：Link_Alive
+// 功能：收到发送端的有效数据
+// 参数：Time - 接收时间（us）
+// 返回值：无
+// 说明：链路由中断恢复时立即请求关键帧，发送端角度不变、只发心跳时也能尽快取回当前角度
+// ==================================================================
+static void Link_Alive(uint32_t Time){
+
+    if(Link_Failsafe.State==LINK_STATE_LOST){
+        Bluetooth_Request_Key();
+    }
+    Failsafe_Feed(&Link_Failsafe,Time);
+
+}
+
+// ==================================================================
+// 函数名：Servo_MapAxis
+// 功能：按轴映射设置一个舵机的目标角度
+// 参数：servo - 舵机状态，map - 轴映射（见AXIS_MAP1），angle1、angle2 - 发送端给出的角度（度）
+// 返回值：无
+// 说明：进行范围保护并换算为舵机输出角度；映射为0时不改变目标角度
+// ==================================================================
+static void Servo_MapAxis(ServoState *servo,float map,float angle1,float angle2){
+
+    float angle;
+
+    switch((int8_t)map){
+        case 1:  angle = angle1;       break;
+        case 2:  angle = angle2;       break;
+        case -1: angle = 180 - angle1; break;
+        case -2: angle = 180 - angle2; break;
+        default: return;
+    }
+    // 角度范围保护
+    servo->target = 180 - ((angle < servo->min) ? servo->min :((angle > servo->max) ? servo->max : angle));
+
+}
+
+// ==================================================================
+// 函数名：Servo_SetTarget
+// 功能：设置两个舵机的目标角度
+// 参数：angle1、angle2 - 发送端给出的角度（度）
+// 返回值：无
+// 说明：同一发送端驱动的各云台安装方向可以不同，由本板的轴映射决定舵机跟随哪个角度
+// ==================================================================
+static void Servo_SetTarget(float angle1,float angle2){
+
+    Servo_MapAxis(&servo1,tune.axis1,angle1,angle2);
+    Servo_MapAxis(&servo2,tune.axis2,angle1,angle2);
+
+}
+
+// 不回放时样本乱序的容限（时间戳单位，约0.5s）
+#define SAMPLE_STALE (uint16_t)(500000UL>>LATENCY_STAMP_SHIFT)
+
 // ==================================================================
+// 函数名：Servo_Sample
+// 功能：处理一个带时间戳的角度样本
+// 参数：stamp - 采样时间戳，s1_int、s2_int - 角度（0.1°），Time - 接收时间（us）
+// 返回值：1 - 样本被采用（进入回放或设为目标角度），0 - 样本过时或迟到而被丢弃
+// 说明：打开回放时交给Angle_Playout按时间戳插值，否则立即作为目标角度；
+//       前向纠错还原的包晚于同组后续的包到达，不回放时比已用样本旧的样本被丢弃，
+//       旧于SAMPLE_STALE以上视为发送端重新上电，照常使用
+// ==================================================================
+static uint8_t Servo_Sample(uint16_t stamp,uint16_t s1_int,uint16_t s2_int,uint32_t Time){
+
+    static uint16_t lastStamp=0;
+    uint16_t age=(uint16_t)(lastStamp-stamp);
+
+    // 转换为浮点角度值（0.1°精度转换为1°精度）
+    if((uint8_t)tune.playMode!=PLAYOUT_OFF){
+        return Playout_Push(&Angle_Playout,stamp,Time,(float)s1_int/10.0f,(float)s2_int/10.0f);
+    }
+    if(age==0||age>SAMPLE_STALE){
+        Servo_SetTarget((float)s1_int/10.0f,(float)s2_int/10.0f);
+        lastStamp=stamp;
+        return 1;
+    }
+    return 0;
+
+}
+
 // ==================================================================
 // 函数名：Parse_DualAngle
-// 功能：解析发送端发送的双舵机角度帧数据
+// 功能：解析发送端发送的双舵机角度消息
+// 参数：Type - 消息类型，Body - MsgAngle消息体，Length - 消息体长度，Time - 接收时间（us）
+// 返回值：无
+// 说明：角度帧为关键帧或相对关键帧的差分帧（格式见AngleCodec.h），解码出两个舵机的
+//       目标角度，并进行范围保护；缺少对应关键帧的差分帧被丢弃，目标角度保持不变，
+//       并请求发送端立即补发关键帧；采样时间戳用于统计帧龄，只统计被采用的样本
+// ==================================================================
+static void Parse_DualAngle(uint8_t Type,const void *Body,uint8_t Length,uint32_t Time){
+
+    const MsgAngle *Angle=(const MsgAngle *)Body;
+    uint16_t s1_int,s2_int;  // 舵机角度值（0.1°精度）
+
+    if(!AngleCodec_Decode(&Angle_Decoder,Angle->Codec,MSG_ANGLE_CODEC(Length),&s1_int,&s2_int)){
+        Bluetooth_Request_Key();
+        return;
+    }
+    Link_Alive(Time);
+    if(Servo_Sample(Angle->Stamp,s1_int,s2_int,Time)){
+        Latency_OnStamp(&Link_Latency,Angle->Stamp,Timer_GetMicros());  // 帧龄：采样到使用的时间，还原或乱序而未用的帧不计
+    }
+
+}
+
+// ==================================================================
+// 函数名：Parse_Batch
+// 功能：解析发送端的批量角度消息
+// 参数：Type - 消息类型，Body - MsgAngleBatch消息体，Length - 消息体长度，Time - 接收时间（us）
+// 返回值：无
+// 说明：各样本为绝对角度，按时间顺序交给回放；未打开回放时只有最后一个样本起作用；
+//       帧龄按被采用的最新样本统计，没有样本被采用时不统计
+// ==================================================================
+static void Parse_Batch(uint8_t Type,const void *Body,uint8_t Length,uint32_t Time){
+
+    const MsgAngleBatch *Batch=(const MsgAngleBatch *)Body;
+    uint16_t stamp,newest=0;
+    uint8_t i,used=0;
+
+    if(Batch->Count==0 || Batch->Count>MSG_BATCH_MAX || Length<MSG_BATCH_LENGTH(Batch->Count)){
+        Bluetooth_RxStats.Malformed++;
+        return;
+    }
+    Link_Alive(Time);
+    for(i=0;i<Batch->Count;i++){
+        stamp=Batch->Stamp+Batch->Offset[i];
+        if(Servo_Sample(stamp,Batch->Angle[i][0],Batch->Angle[i][1],Time)){
+            newest=stamp;
+            used=1;
+        }
+    }
+    if(used){
+        Latency_OnStamp(&Link_Latency,newest,Timer_GetMicros());
+    }
+
+}
+
+// ==================================================================
+// 函数名：Tilt_ToServo
+// 功能：把倾角换算为舵机角度（0.1°）
+// 参数：tilt - 倾角（度），servo - 舵机状态（取其角度范围）
+// 返回值：舵机角度（0.1°）
+// 说明：倾角±tune.angleRange线性对应舵机的[min, max]，超出部分限幅
+// ==================================================================
+static uint16_t Tilt_ToServo(float tilt,const ServoState *servo){
+
+    float range=tune.angleRange;
+
+    tilt=(tilt<-range)?-range:((tilt>range)?range:tilt);
+    return (uint16_t)((((tilt+range)/(2*range))*(servo->max-servo->min)+servo->min)*10);
+
+}
+
+// ==================================================================
+// 函数名：Parse_Quat
+// 功能：解析发送端的姿态四元数消息
+// 参数：Type - 消息类型，Body - MsgQuat消息体，Length - 消息体长度，Time - 接收时间（us）
+// 返回值：无
+// 说明：还原重力方向，按与发送端角度模式相同的方法求出两个倾角，再按本板的倾角范围和
+//       舵机范围换算为舵机角度，之后与角度消息一样经回放和轴映射设置目标角度；
+//       四元数是完整姿态，不依赖关键帧
+// ==================================================================
+static void Parse_Quat(uint8_t Type,const void *Body,uint8_t Length,uint32_t Time){
+
+    const MsgQuat *Msg=(const MsgQuat *)Body;
+    Quat q;
+    float gx,gy,gz;
+
+    QuatCodec_Unpack(Msg->Packed,q);
+    QuatCodec_ToGravity(q,&gx,&gy,&gz);
+    if(fabs(gz)<0.1f){
+        gz=(gz>0)?0.1f:-0.1f;  // 与发送端相同的除零保护
+    }
+    Link_Alive(Time);
+    if(Servo_Sample(Msg->Stamp,Tilt_ToServo(atan(gx/gz)*180/3.14159f,&servo1),
+                    Tilt_ToServo(atan(gy/gz)*180/3.14159f,&servo2),Time)){
+        Latency_OnStamp(&Link_Latency,Msg->Stamp,Timer_GetMicros());
+    }
+
+}
+
+// ==================================================================
+// 函数名：Parse_Pong
+// 功能：处理发送端对时延探测的应答
+// 参数：Type - 消息类型，Body - MsgPong消息体，Length - 消息体长度，Time - 接收时间（us）
+// 返回值：无
+// ==================================================================
+static void Parse_Pong(uint8_t Type,const void *Body,uint8_t Length,uint32_t Time){
+
+    Latency_OnPong(&Link_Latency,(const MsgPong *)Body,Time);
+
+}
+
+// ==================================================================
+// 函数名：Parse_Heartbeat
+// 功能：处理发送端的心跳
+// 参数：Type - 消息类型，Body - MsgHeartbeat消息体，Length - 消息体长度，Time - 接收时间（us）
+// 返回值：无
+// 说明：发送端没有新角度时以心跳表明链路正常
+// ==================================================================
+static void Parse_Heartbeat(uint8_t Type,const void *Body,uint8_t Length,uint32_t Time){
+
+    Link_Alive(Time);
+
+}
+
+// ==================================================================
+// 函数名：Parse_Stat
+// 功能：处理统计报告请求
+// 参数：Type - 消息类型，Body - 消息体（保留），Length - 消息体长度，Time - 接收时间（us）
+// 返回值：无
+// 说明：输出链路统计和循环监测报告，经遥测串口发出；请求按目标地址过滤，只有被请求的云台应答
+// ==================================================================
+static void Parse_Stat(uint8_t Type,const void *Body,uint8_t Length,uint32_t Time){
+
+    Link_Report();
+    Monitor_Report();
+
+}
+
+// ==================================================================
+// 函数名：Parse_Param
+// 功能：处理读/写参数命令及其应答
+// 参数：Type - 消息类型，Body - 参数消息体，Length - 消息体长度，Time - 接收时间（us）
+// 返回值：无
+// 说明：目标为接收端的命令在此执行并应答；目标为发送端的命令原样转发给发送端，
+//       发送端的应答同样原样转发，命令来源只需连接接收端即可调整两块板的参数；
+//       修改编号或所在组后立即生效
+// ==================================================================
+static void Parse_Param(uint8_t Type,const void *Body,uint8_t Length,uint32_t Time){
+
+    MsgParamAck Ack;
+    uint8_t AckLength;
+
+    if(Type==MSG_PARAM_ACK || ((const uint8_t *)Body)[0]==PARAM_DEST_SENDER){
+        Serial_SendMessage(Type,Body,Length,0);  // 转发
+        return;
+    }
+    AckLength=Param_Handle(&Tune_Table,Type,(const uint8_t *)Body,Length,(uint8_t *)&Ack);
+    Bluetooth_Set_Address();
+    if(AckLength>0){
+        Serial_SendMessage(MSG_PARAM_ACK,&Ack,AckLength,0);
+    }
+
+}
+
+// 接收消息分发表：未列出的类型按长度跳过，最小长度见Message.h的MSG_LIST
+static const ProtoEntry Bluetooth_Table[]={
+    {MSG_ANGLE,MSG_ANGLE_MIN,Parse_DualAngle},
+    {MSG_ANGLE_BATCH,MSG_ANGLE_BATCH_MIN,Parse_Batch},
+    {MSG_QUAT,MSG_QUAT_MIN,Parse_Quat},
+    {MSG_PONG,MSG_PONG_MIN,Parse_Pong},
+    {MSG_PARAM_GET,MSG_PARAM_GET_MIN,Parse_Param},
+    {MSG_PARAM_SET,MSG_PARAM_SET_MIN,Parse_Param},
+    {MSG_PARAM_ACK,MSG_PARAM_ACK_MIN,Parse_Param},
+    {MSG_HEARTBEAT,MSG_HEARTBEAT_MIN,Parse_Heartbeat},
+    {MSG_STAT_REQUEST,MSG_STAT_REQUEST_MIN,Parse_Stat},
+};
+
+// ==================================================================
+// 函数名：Bluetooth_Set_Address
+// 功能：按参数设置本接收端的地址
 // 参数：无
 // 返回值：无
-// 说明：从串口接收的数据包中解析出两个舵机的目标角度，并进行范围保护
+// 说明：上电时和修改参数后调用；本板发出的消息（时延探测、参数应答等）都发给发送端
 // ==================================================================
-void Parse_DualAngle(){
+void Bluetooth_Set_Address(void){
 
-    
-    // 拼接16位角度数据（发送端以0.1°精度发送，高字节在前，低字节在后）
-    uint16_t s1_int = Serial_RxPacket[0] | (Serial_RxPacket[1] << 8);  // 舵机1角度值（16位）
-    uint16_t s2_int = Serial_RxPacket[2] | (Serial_RxPacket[3] << 8);  // 舵机2角度值（16位）
+    Proto_SetAddress((uint8_t)tune.nodeId,(uint8_t)tune.nodeGroups,PROTO_ADDR_HOST);
 
-    // 转换为浮点角度值（0.1°精度转换为1°精度）
-    servo1.target = (float)s1_int / 10.0f;  // 舵机1目标角度
-    servo2.target = (float)s2_int / 10.0f;  // 舵机2目标角度
+}
 
-    // 角度范围保护
-    servo1.target = 180 - ((servo1.target < servo1.min) ? servo1.min :((servo1.target > servo1.max) ? servo1.max : servo1.target));
-    servo2.target = 180 - ((servo2.target < servo2.min) ? servo2.min :((servo2.target > servo2.max) ? servo2.max : servo2.target));
-    
+// ==================================================================
+// 函数名：Bluetooth_Receive
+// 功能：分发接收队列中的一个数据包
+// 参数：Packet - 数据包（[版本][目标][来源]后接若干[类型][长度][消息体]），Length - 数据包长度，
+//       Time - 接收时间（us）
+// 返回值：无
+// 说明：主版本不一致或目标不是本板的数据包整体丢弃，格式错误与未知类型计入Bluetooth_RxStats
+// ==================================================================
+void Bluetooth_Receive(const uint8_t *Packet,uint8_t Length,uint32_t Time){
+
+    Proto_Dispatch(Bluetooth_Table,sizeof(Bluetooth_Table)/sizeof(Bluetooth_Table[0]),
+                   &Bluetooth_RxStats,Packet,Length,Time);
+
+}
+
+// ==================================================================
+// 函数名：Bluetooth_IsSnapshot
+// 功能：判断接收队列中的一帧是否为完整的目标角度（可被紧随其后的同类帧取代）
+// 参数：Frame - 队列中的一帧
+// 返回值：1 - 只含四元数、批量角度或角度关键帧，0 - 其他
+// 说明：供FrameQueue_PeekNewest在主循环来不及处理时跳过旧的完整角度（计入Stale）；
+//       差分帧依赖之前的关键帧，应答、心跳等消息各有作用，都不可跳过；
+//       打开回放时每个样本都按时间戳插值，也不跳过；格式不对的帧留给Proto_Dispatch计数
+// ==================================================================
+uint8_t Bluetooth_IsSnapshot(const QueueFrame *Frame){
+
+    const uint8_t *p=Frame->Data;
+    uint8_t offset=3;  // 跳过[版本][目标][来源]
+
+    if((uint8_t)tune.playMode!=PLAYOUT_OFF || Frame->Length<PROTO_HEADER ||
+       PROTO_MAJOR(p[0])!=PROTO_MAJOR(PROTO_VERSION)){
+        return 0;
+    }
+    while(offset<Frame->Length){
+        if(Frame->Length-offset<2 || Frame->Length-offset-2<p[offset+1]){
+            return 0;
+        }
+        switch(p[offset]){
+            case MSG_QUAT:
+            case MSG_ANGLE_BATCH:
+                break;
+            case MSG_ANGLE:  // 关键帧：Codec[0]最高位为1
+                if(p[offset+1]<MSG_ANGLE_LENGTH(ANGLE_KEY_LENGTH) || !(p[offset+2+MSG_ANGLE_LENGTH(0)]&ANGLE_KEY_FLAG)){
+                    return 0;
+                }
+                break;
+            default:
+                return 0;
+        }
+        offset+=2+p[offset+1];
+    }
+    return 1;
+
+}
+
+// ==================================================================
+// 函数名：Bluetooth_Send_Ping
+// 功能：按周期向发送端发出时延探测
+// 参数：无
+// 返回值：无
+// 说明：每个主循环调用一次，间隔和超时见Latency.h；PING不可被替换
+// ==================================================================
+void Bluetooth_Send_Ping(void){
+
+    MsgPing Ping;
+
+    if(Latency_MakePing(&Link_Latency,Timer_GetMicros(),&Ping)){
+        Serial_SendMessage(MSG_PING,&Ping,sizeof(Ping),0);
+    }
+
+}
+
+// ==================================================================
+// 函数名：Bluetooth_Send_Credit
+// 功能：向发送端通告流控信用
+// 参数：无
+// 返回值：无
+// 说明：每个主循环在处理完接收队列后调用一次，确认的序号即已处理完的数据包；
+//       窗口不超过接收队列的空闲槽数；信用可被替换，新的信用包含旧信用的全部信息
+// ==================================================================
+void Bluetooth_Send_Credit(void){
+
+    MsgCredit Credit;
+    uint8_t window=(uint8_t)tune.flowWindow;
+    uint8_t room=FRAME_QUEUE_SIZE-FrameQueue_Count(&Serial_RxQueue);
+
+    if(window>room){
+        window=room;
+    }
+    if(window==0 && (uint8_t)tune.flowWindow>0){
+        window=1;  // 队列已满时仍允许一个包在途，确认序号得以继续前进
+    }
+    if(Flow_MakeCredit(&Link_Advert,&Serial_RxStats,window,Timer_GetMicros(),&Credit)){
+        Serial_SendMessage(MSG_CREDIT,&Credit,sizeof(Credit),1);
+    }
+
+}
+
+// ==================================================================
+// 函数名：Bluetooth_Send_Report
+// 功能：向发送端报告链路接收统计
+// 参数：无
+// 返回值：无
+// 说明：每个主循环调用一次，每RATE_REPORT_INTERVAL报告一次累计的接受、丢失、CRC错误数和
+//       本端的溢出次数（串口溢出、环形缓冲区被覆盖、接收队列已满），发送端据此自适应发送速率（见Rate.h）；
+//       报告不可被替换：与同一循环内的信用紧挨着发出，Rate_MakeReport已记下本次报告时间，
+//       被替换就要等下一个报告周期，发送端会把这段空白误判为链路拥塞
+// ==================================================================
+void Bluetooth_Send_Report(void){
+
+    MsgLinkReport Report;
+    uint32_t overflow=Serial_RxOverrun+Serial_RxOverflow+Serial_RxQueue.Overflow;
+
+    if(Rate_MakeReport(&Link_RateAdvert,&Serial_RxStats,overflow,Timer_GetMicros(),&Report)){
+        Serial_SendMessage(MSG_LINK_REPORT,&Report,sizeof(Report),0);
+    }
+
+}
+
+// ==================================================================
+// 函数名：Telemetry_Send_Status
+// 功能：按周期从遥测串口发出运行状态
+// 参数：无
+// 返回值：无
+// 说明：每个主循环调用一次，每TELEMETRY_INTERVAL发出一条MSG_TELEMETRY（往返时延、帧龄、丢包、
+//       链路质量和最长循环周期），不经过蓝牙链路
+// ==================================================================
+void Telemetry_Send_Status(void){
+
+    static uint32_t lastSend=0;
+    uint32_t now=Timer_GetMicros();
+    uint32_t loopMax=Monitor_MaxPeriod();
+    MsgTelemetry msg;
+
+    if(now-lastSend<TELEMETRY_INTERVAL){
+        return;
+    }
+    lastSend=now;
+    msg.RttAvg=Link_Latency.RttAvg;
+    msg.AgeAvg=Link_Latency.AgeAvg;
+    msg.Lost=Serial_RxStats.Lost;
+    msg.Source=PARAM_DEST_RECEIVER;
+    msg.Quality=Link_Quality(&Serial_RxStats);
+    msg.LoopMax=(uint16_t)(loopMax>0xFFFF?0xFFFF:loopMax);
+    Telemetry_SendMessage(MSG_TELEMETRY,&msg,sizeof(msg));
+
+}
+
+// ==================================================================
+// 函数名：Link_Report
+// 功能：输出链路统计（写入日志缓冲区，由Telemetry_DrainLog从遥测串口发出）
+// 参数：无
+// 返回值：无
+// 说明：RX为串口接收错误（stale为被更新的完整角度取代而跳过的帧数），LINK为数据包校验与链路质量（flt为发给其他云台而丢弃的包数），
+//       FEC为收到的校验帧数、还原的包数和一组丢失多个而无法还原的次数，LAT为往返时延，SYNC为时钟偏差（us）、
+//       频率偏差（ppb）、最近一次偏差测量的预测误差（us）和重新同步次数，AGE为帧龄及其直方图，
+//       PLAY为抖动缓冲深度、当前延时与抖动峰值（us）、欠载/迟到丢弃/重新对齐次数，FS为链路中断次数及中断时长（us）
+// ==================================================================
+void Link_Report(void){
+
+    uint8_t i;
+
+    // 单条日志最多LOG_MAX_ARGS个参数，参数多的行分几条写入
+    LOG("RX ovf=%lu ore=%lu ne=%lu fe=%lu q=%lu",
+        Serial_RxOverflow,Serial_RxOverrun,Serial_RxNoise,Serial_RxFraming,Serial_RxQueue.Overflow);
+    LOG(" stale=%lu",Serial_RxQueue.Stale);
+    LOG(" cobs=%lu key=%lu ver=%lu unk=%lu bad=%lu\r\n",
+        Serial_RxDecoder.Errors,Angle_Decoder.KeyMiss,Bluetooth_RxStats.Version,
+        Bluetooth_RxStats.Unknown,Bluetooth_RxStats.Malformed);
+    LOG("LINK q=%u rx=%lu crc=%lu lost=%lu",
+        Link_Quality(&Serial_RxStats),Serial_RxStats.Received,Serial_RxStats.CrcErrors,Serial_RxStats.Lost);
+    LOG(" dup=%lu ord=%lu node=%u flt=%lu\r\n",Serial_RxStats.Duplicates,Serial_RxStats.Reordered,
+        (uint32_t)tune.nodeId,Bluetooth_RxStats.Filtered);
+    LOG("FEC par=%lu rec=%lu unrec=%lu\r\n",Serial_RxFec.Parity,Serial_RxFec.Recovered,Serial_RxFec.Unrecoverable);
+    LOG("LAT n=%lu to=%lu rtt=%lu",Link_Latency.Samples,Link_Latency.Timeouts,Link_Latency.Rtt);
+    LOG(" min=%lu avg=%lu max=%lu\r\n",
+        Link_Latency.Samples?Link_Latency.RttMin:0,Link_Latency.RttAvg,Link_Latency.RttMax);
+    LOG("SYNC off=%ld drift=%ld err=%ld resync=%lu\r\n",(int32_t)Link_Latency.Offset,
+        Link_Latency.DriftValid?Link_Latency.Drift:0,Link_Latency.SyncError,Link_Latency.Resyncs);
+    LOG("AGE now=%lu avg=%lu",Link_Latency.Age,Link_Latency.AgeAvg);
+    for(i=0;i<LATENCY_HIST_NUM;i++){
+        if(i<LATENCY_HIST_NUM-1){
+            LOG(" <%lu:%lu",Latency_HistEdge[i],Link_Latency.Hist[i]);
+        }
+        else{
+            LOG(" >=%lu:%lu",Latency_HistEdge[i-1],Link_Latency.Hist[i]);
+        }
+    }
+    LOG("\r\n");
+    LOG("PLAY mode=%u depth=%u delay=%lu jit=%lu",
+        (uint32_t)tune.playMode,Angle_Playout.Count,Angle_Playout.Delay,Angle_Playout.Peak);
+    LOG(" und=%lu late=%lu sync=%lu\r\n",Angle_Playout.Underruns,Angle_Playout.Late,Angle_Playout.Resyncs);
+    LOG("FS state=%u policy=%u loss=%lu last=%lu max=%lu\r\n",
+        Link_Failsafe.State,(uint32_t)tune.failPolicy,Link_Failsafe.Losses,
+        Link_Failsafe.LastOutage,Link_Failsafe.MaxOutage);
+
+}
+
+// ==================================================================
+// 函数名：Link_StateText
+// 功能：返回链路状态的显示文字
+// 参数：无
+// 返回值：4个字符的字符串，正常为"OK"，中断时为正在执行的策略
+// ==================================================================
+char *Link_StateText(void){
+
+    if(Link_Failsafe.State==LINK_STATE_OK){
+        return "OK  ";
+    }
+    switch((uint8_t)tune.failPolicy){
+        case FAILSAFE_HOME: return "HOME";
+        case FAILSAFE_LIMP: return "LIMP";
+        default:            return "HOLD";
+    }
 
 }
 
@@ -69,58 +627,156 @@ void Parse_DualAngle(){
 static float CalculateStep(float absDiff){
 
     // 小角度差（微调），使用小步长
-    if(absDiff <= SMALL_ANGLE){
-        return SMALL_STEP;
+    if(absDiff <= tune.smallAngle){
+        return tune.smallStep;
     }
     // 中等角度差，使用线性插值的步长（平滑过渡）
-    else if(absDiff <= LARGE_ANGLE){
-        return SMALL_STEP + (LARGE_STEP - SMALL_STEP) * (absDiff - SMALL_ANGLE) / (LARGE_ANGLE - SMALL_ANGLE);
+    else if(absDiff <= tune.largeAngle){
+        return tune.smallStep + (tune.largeStep - tune.smallStep) * (absDiff - tune.smallAngle) / (tune.largeAngle - tune.smallAngle);
     }
     // 大角度差（快速调整），使用大步长
     else{
-        return LARGE_STEP;
+        return tune.largeStep;
     }
 }
 
 // ==================================================================
-// 函数名：Servo_SmoothControl
-// 功能：双舵机平滑控制主函数
+// 函数名：Servo_Playout
+// 功能：按回放时刻更新目标角度
 // 参数：无
 // 返回值：无
-// 说明：根据目标角度和当前角度的差值，计算平滑的步进值，实现舵机的无抖动运动
+// 说明：每个主循环在舵机平滑控制之前调用一次，回放关闭时不做任何事
 // ==================================================================
-void Servo_SmoothControl(){
+void Servo_Playout(void){
+
+    float angle1,angle2;
+    uint8_t mode=(uint8_t)tune.playMode;
+
+    if(mode==PLAYOUT_OFF){
+        return;
+    }
+    Angle_Playout.MaxDelay=(uint32_t)(tune.playDelay*1000);  // 参数修改即时生效
+    Angle_Playout.Adaptive=(uint8_t)tune.playAdapt;
+    if(Playout_Get(&Angle_Playout,Timer_GetMicros(),mode,&angle1,&angle2)){
+        Servo_SetTarget(angle1,angle2);
+    }
+
+}
 
-    // 舵机1平滑控制
-    float diff1 = servo1.target - servo1.current;  // 计算角度差（目标角度 - 当前角度）
-    float step1 = CalculateStep(fabs(diff1));      // 根据角度差绝对值计算步进值
+// ==================================================================
+// 函数名：Servo_Step
+// 功能：单个舵机向目标角度前进一步
+// 参数：servo - 舵机状态，limit - 步长上限（°），0表示不限
+// 返回值：无
+// ==================================================================
+static void Servo_Step(ServoState *servo,float limit){
+
+    float diff = servo->target - servo->current;  // 计算角度差（目标角度 - 当前角度）
+    float step = CalculateStep(fabs(diff));       // 根据角度差绝对值计算步进值
 
-    if(diff1 > step1){
-        servo1.current += step1;  // 正向调整角度
+    if(limit > 0 && step > limit){
+        step = limit;  // 失效保护回位时限制速度
     }
-    else if(diff1 < -step1){
-        servo1.current -= step1;  // 反向调整角度
+
+    if(diff > step){
+        servo->current += step;  // 正向调整角度
+    }
+    else if(diff < -step){
+        servo->current -= step;  // 反向调整角度
     }
     else{
-        servo1.current = servo1.target;  // 角度差小于最小步长，直接到达目标
+        servo->current = servo->target;  // 角度差小于最小步长，直接到达目标
     }
 
-    // 舵机2平滑控制（与舵机1控制逻辑相同）
-    float diff2 = servo2.target - servo2.current;  // 计算角度差
-    float step2 = CalculateStep(fabs(diff2));      // 根据角度差绝对值计算步进值
+}
 
-    if(diff2 > step2){
-        servo2.current += step2;  // 正向调整角度
+// ==================================================================
+// 函数名：Servo_SmoothControl
+// 功能：双舵机平滑控制主函数
+// 参数：无
+// 返回值：无
+// 说明：根据目标角度和当前角度的差值，计算平滑的步进值，实现舵机的无抖动运动；
+//       链路中断时按失效保护策略保持、以HOME_SPEED回到预设位置或让舵机卸力，
+//       链路恢复后从当前位置平滑跟随新的目标角度；回位步长按距上次调用的实测时间计算，
+//       主循环周期（延时加各任务耗时）大于LOOP_INTERVAL时回位速度仍为设定值
+// ==================================================================
+void Servo_SmoothControl(){
+
+    static uint32_t lastStep = 0;  // 上次调用的时间（us）
+    uint32_t now = Timer_GetMicros();
+    uint32_t elapsed = now - lastStep;
+    float limit = 0;
+
+    lastStep = now;
+    if(elapsed > HOME_STEP_MAX){
+        elapsed = HOME_STEP_MAX;  // 长时间阻塞后不一步跳过去
     }
-    else if(diff2 < -step2){
-        servo2.current -= step2;  // 反向调整角度
+    if(elapsed == 0){
+        elapsed = 1;
     }
-    else{
-        servo2.current = servo2.target;  // 角度差小于最小步长，直接到达目标
+
+    if(Link_Failsafe.State == LINK_STATE_LOST){
+        switch((uint8_t)tune.failPolicy){
+            case FAILSAFE_HOME:
+                servo1.target = tune.home1;
+                servo2.target = tune.home2;
+                limit = tune.homeSpeed * elapsed / 1000000.0f;  // °/s按实测间隔换算为本次的步长
+                break;
+            case FAILSAFE_LIMP:
+                Servo_Release();
+                return;
+            default:
+                break;
+        }
     }
 
+    Servo_Step(&servo1,limit);  // 舵机1平滑控制
+    Servo_Step(&servo2,limit);  // 舵机2平滑控制
+
     // 将计算得到的角度值应用到实际舵机
     Servo_SetAngle1((uint16_t)servo1.current);  // 设置舵机1当前位置
     Servo_SetAngle2((uint16_t)servo2.current);  // 设置舵机2当前位置
 
-}
\ No newline at end of file
+}
+
+// ==================================================================
+// 函数名：Servo_SaveState
+// 功能：将舵机当前角度和目标角度保存到备份寄存器
+// 参数：无
+// 返回值：无
+// 说明：每个主循环调用一次，看门狗或复位键复位后据此恢复，舵机不会跳回90°
+// ==================================================================
+void Servo_SaveState(void){
+
+    uint16_t state[4];
+
+    state[0] = (uint16_t)(servo1.current * 10);  // 以0.1°精度保存，与角度帧一致
+    state[1] = (uint16_t)(servo2.current * 10);
+    state[2] = (uint16_t)(servo1.target * 10);
+    state[3] = (uint16_t)(servo2.target * 10);
+    Watchdog_SaveState(state, 4);
+
+}
+
+// ==================================================================
+// 函数名：Servo_RestoreState
+// 功能：热启动时从备份寄存器恢复舵机角度
+// 参数：无
+// 返回值：1表示已恢复，0表示冷启动（保持默认90°）
+// 说明：需在Servo_Init之后、第一次设置舵机角度之前调用
+// ==================================================================
+uint8_t Servo_RestoreState(void){
+
+    uint16_t state[4];
+
+    if(!Watchdog_LoadState(state, 4)){
+        return 0;
+    }
+
+    servo1.current = (float)state[0] / 10.0f;
+    servo2.current = (float)state[1] / 10.0f;
+    servo1.target  = (float)state[2] / 10.0f;
+    servo2.target  = (float)state[3] / 10.0f;
+    return 1;
+
+}
@@ -1,21 +1,87 @@
 #ifndef __SUNDRIES_H__
 #define __SUNDRIES_H__
 
-// 舵机角度范围（与发送端严格匹配）
-#define SERVO1_MIN      30.0f        
-#define SERVO1_MAX     150.0f        
-#define SERVO2_MIN       0.0f        
-#define SERVO2_MAX     180.0f  
+#include "AngleCodec.h"
+#include "Latency.h"
+#include "Param.h"
+#include "Proto.h"
+#include "Failsafe.h"
+#include "Playout.h"
+#include "Flow.h"
+#include "Rate.h"
+#include "FrameQueue.h"
+#include "Gimbal.h"                  // 倾角范围、舵机范围和主循环间隔，与发送端共用
 
-#define FRAME_LENGTH       6     // 角度帧固定长度：1字节头 + 2字节S1 + 2字节S2 + 1字节尾
-#define ANGLE_FRAME_HEADER 0xFF      // 角度帧头
-#define ANGLE_FRAME_TAIL   0xFE      // 角度帧尾
 
 #define SMALL_ANGLE      5.0f        // 小角度阈值
 #define LARGE_ANGLE     15.0f        // 大角度阈值
 #define SMALL_STEP       0.8f        // 小步长（微调无抖动）
 #define LARGE_STEP       7.0f        // 大步长（快速到位）
 
+#define WATCHDOG_TIMEOUT 1000        // 看门狗超时（ms），需大于统计报告等最长阻塞时间
+
+// 链路失效保护（策略见Failsafe.h）
+#define FAILSAFE_TIMEOUT   100       // 链路超时（ms），最小3个主循环周期，且需大于心跳间隔
+#define FAILSAFE_POLICY    FAILSAFE_HOLD  // 链路中断时的策略
+#define HOME_SPEED        60.0f      // 回到预设位置的速度（°/s）
+#define HOME_STEP_MAX     50000      // 回位单步最长按此时间计算（us），主循环被长时间阻塞后不会一步跳到位
+#define HOME_ANGLE1       90.0f      // 舵机1预设位置（舵机输出角度）
+#define HOME_ANGLE2       90.0f      // 舵机2预设位置（舵机输出角度）
+#define KEY_REQUEST_INTERVAL 50      // 请求关键帧的最小间隔（ms），略大于往返时延
+
+// 抖动缓冲：按发送端时间戳排序，以固定延时插值回放（见Playout.h），吸收蓝牙的突发传输
+#define PLAYOUT_MODE      PLAYOUT_LINEAR  // PLAYOUT_OFF/LINEAR/HERMITE，关闭时收到即用
+#define PLAYOUT_DELAY     60         // 回放延时上限（ms），非自适应时即固定延时
+#define PLAYOUT_ADAPT      1         // 1：延时随实测抖动自适应，0：固定为PLAYOUT_DELAY
+
+// 多云台寻址：一个发送端驱动多个接收端时，每块接收端板设置不同的编号（见Proto.h），
+// 发给其他编号或未加入的组的数据包在解析前丢弃
+#define NODE_ID            1         // 本接收端编号，1~PROTO_ADDR_NODE_MAX
+#define NODE_GROUPS     0x01         // 加入的组（按位），第g位对应PROTO_ADDR_GROUP(g)
+
+// 四元数模式（发送端SEND_MODE_QUAT）下由本板把倾角换算为舵机角度：
+// 倾角±ANGLE_RANGE（Gimbal.h）线性对应舵机1/2的[MIN, MAX]，与发送端角度模式的换算相同
+
+// 轴映射：舵机跟随发送端的哪个角度，1/2为角度1/2，-1/-2为镜像（180°-角度），0为不跟随（保持当前目标）
+#define AXIS_MAP1          1         // 舵机1
+#define AXIS_MAP2          2         // 舵机2
+
+// 信用流控：定期向发送端通告已处理的链路序号和窗口，在途数据包达到窗口时发送端暂停发送角度，
+// 蓝牙模块中最多积压FLOW_WINDOW个数据包；窗口需覆盖往返时延内的发包数，过小会限制正常发送速率
+#define FLOW_WINDOW        8         // 窗口（数据包数），0表示不参与流控
+
+// 可在线调整的参数编号（接收端），上电默认值为上面的宏定义
+#define PARAM_SMALL_ANGLE  1         // SMALL_ANGLE
+#define PARAM_LARGE_ANGLE  2         // LARGE_ANGLE
+#define PARAM_SMALL_STEP   3         // SMALL_STEP
+#define PARAM_LARGE_STEP   4         // LARGE_STEP
+#define PARAM_SERVO1_MIN   5         // SERVO1_MIN
+#define PARAM_SERVO1_MAX   6         // SERVO1_MAX
+#define PARAM_SERVO2_MIN   7         // SERVO2_MIN
+#define PARAM_SERVO2_MAX   8         // SERVO2_MAX
+#define PARAM_FAILSAFE_TIMEOUT 9     // FAILSAFE_TIMEOUT
+#define PARAM_FAILSAFE_POLICY 10     // FAILSAFE_POLICY
+#define PARAM_HOME_SPEED  11         // HOME_SPEED
+#define PARAM_HOME_ANGLE1 12         // HOME_ANGLE1
+#define PARAM_HOME_ANGLE2 13         // HOME_ANGLE2
+#define PARAM_PLAYOUT_MODE 14        // PLAYOUT_MODE
+#define PARAM_PLAYOUT_DELAY 15       // PLAYOUT_DELAY
+#define PARAM_PLAYOUT_ADAPT 16       // PLAYOUT_ADAPT
+#define PARAM_NODE_ID     17         // NODE_ID，修改后的应答已使用新编号
+#define PARAM_NODE_GROUPS 18         // NODE_GROUPS
+#define PARAM_AXIS_MAP1   19         // AXIS_MAP1
+#define PARAM_AXIS_MAP2   20         // AXIS_MAP2
+#define PARAM_FLOW_WINDOW 21         // FLOW_WINDOW
+#define PARAM_ANGLE_RANGE 22         // ANGLE_RANGE
+
+// 主循环任务编号及单次执行预算（us），用于循环耗时监测
+#define TASK_PARSE         0         // 角度帧解析
+#define TASK_SERVO         1         // 舵机平滑控制
+#define TASK_OLED          2         // OLED刷新
+#define TASK_PARSE_BUDGET  200
+#define TASK_SERVO_BUDGET  200
+#define TASK_OLED_BUDGET  2000
+
 typedef struct {
     float target;       // 目标角度（从发送端解析得到）
     float current;      // 当前角度（舵机实际位置，用于平滑控制）
@@ -23,12 +89,50 @@ typedef struct {
     float max;          // 最大角度限制
 } ServoState;
 
+typedef struct {
+    float smallAngle;   // 小角度阈值
+    float largeAngle;   // 大角度阈值
+    float smallStep;    // 小步长
+    float largeStep;    // 大步长
+    float failTimeout;  // 链路超时（ms）
+    float failPolicy;   // 失效保护策略（FAILSAFE_HOLD/HOME/LIMP）
+    float homeSpeed;    // 回到预设位置的速度（°/s）
+    float home1;        // 舵机1预设位置
+    float home2;        // 舵机2预设位置
+    float playMode;     // 回放插值方式
+    float playDelay;    // 回放延时上限（ms）
+    float playAdapt;    // 自适应延时开关
+    float nodeId;       // 本接收端编号
+    float nodeGroups;   // 加入的组（按位）
+    float axis1;        // 舵机1轴映射
+    float axis2;        // 舵机2轴映射
+    float flowWindow;   // 流控窗口（数据包数）
+    float angleRange;   // 有效倾角范围（±度），四元数模式使用
+} TuneParam;
+
 // 外部变量声明
 extern ServoState servo1;
 extern ServoState servo2;
+extern AngleDecoder Angle_Decoder;
+extern Latency Link_Latency;
+extern ProtoStats Bluetooth_RxStats;
+extern Failsafe Link_Failsafe;
+extern Playout Angle_Playout;
+extern TuneParam tune;
 
 // 函数声明
-void Parse_DualAngle(void);
+void Bluetooth_Set_Address(void);
+void Bluetooth_Receive(const uint8_t *Packet,uint8_t Length,uint32_t Time);
+uint8_t Bluetooth_IsSnapshot(const QueueFrame *Frame);
+void Bluetooth_Send_Ping(void);
+void Bluetooth_Send_Credit(void);
+void Bluetooth_Send_Report(void);
+void Link_Report(void);
+void Telemetry_Send_Status(void);
+char *Link_StateText(void);
+void Servo_Playout(void);
 void Servo_SmoothControl(void);
+void Servo_SaveState(void);
+uint8_t Servo_RestoreState(void);
 
 #endif
\ No newline at end of file
@@ -11,45 +11,94 @@
 #include "Key.h"                        // 按键输入库
 #include "Sundries.h"                   // 杂项功能库（角度解析、平滑控制）
 #include "Servo.h"                      // 舵机控制库
+#include "Timer.h"                      // 微秒时间基准
+#include "Monitor.h"                    // 循环耗时监测
+#include "Watchdog.h"                   // 看门狗与热启动
+#include "HC05.h"                       // 蓝牙模块波特率协商
+#include "Telemetry.h"                  // 遥测串口（日志、统计）
 #include <math.h>                       // 数学函数库
 
 int main(void){
 
+    // 最先恢复舵机位置：热启动时沿用复位前的角度，冷启动为默认90°
+    Servo_Init();          // 初始化舵机PWM控制
+    Servo_RestoreState();  // 热启动时从备份寄存器恢复舵机状态
+    Servo_SetAngle1((uint16_t)servo1.current);  // 设置舵机1初始位置
+    Servo_SetAngle2((uint16_t)servo2.current);  // 设置舵机2初始位置
+
 	OLED_Init();      // 初始化OLED显示屏
 	Serial_Init();     // 初始化串口通信（波特率等设置）
-    Servo_Init();      // 初始化舵机PWM控制
+    Telemetry_Init();  // 初始化遥测串口（USART2，日志与统计不再占用蓝牙）
+    Timer_Init();      // 初始化微秒时间基准
+    HC05_Init();       // 初始化HC-05 KEY引脚
+    HC05_Negotiate(HC05_TARGET_BAUD);  // 将蓝牙串口提速到目标波特率
+    Bluetooth_Set_Address();           // 本板编号与所在组（NODE_ID、NODE_GROUPS）
+    Latency_Init(&Link_Latency);       // 清零时延统计
+    Failsafe_Init(&Link_Failsafe,Timer_GetMicros());  // 链路超时从此刻开始计时
+    Playout_Init(&Angle_Playout,(uint32_t)(tune.playDelay * 1000));  // 角度样本回放
+
+    // 初始化循环监测，登记各任务及其预算
+    Monitor_Init(LOOP_INTERVAL * 1000);
+    Monitor_AddTask(TASK_PARSE, "PARSE", TASK_PARSE_BUDGET);
+    Monitor_AddTask(TASK_SERVO, "SERVO", TASK_SERVO_BUDGET);
+    Monitor_AddTask(TASK_OLED, "OLED", TASK_OLED_BUDGET);
 
     // 在OLED上显示标题和标签
     OLED_ShowString(1,1,"Servo Ctrl:");  // 主标题
     OLED_ShowString(2,1,"A:");           // 舵机1角度标签
     OLED_ShowString(3,1,"B:");           // 舵机2角度标签
+    OLED_ShowString(4,1,"Q:");           // 链路质量标签（%），其后为链路状态
 
-    // 舵机上电默认中间位置90°
-    Servo_SetAngle1((uint16_t)servo1.current);  // 设置舵机1初始位置
-    Servo_SetAngle2((uint16_t)servo2.current);  // 设置舵机2初始位置
+    // 初始化完成后再启动看门狗，避免OLED等初始化延时触发复位
+    Watchdog_Init(WATCHDOG_TIMEOUT);
 
 	while(1){
+
+        Monitor_LoopBegin();  // 记录循环周期
 		
         // 串口接收处理
-        if (Serial_RxFlag == 1)  // 检查是否收到完整的角度帧
+        Monitor_TaskBegin(TASK_PARSE);
+        Serial_ProcessRx();      // 解析DMA接收到的数据
+        const QueueFrame *RxFrame;
+        // 按顺序处理；主循环来不及时，已被后一帧取代的完整角度（关键帧、四元数、批量角度）直接跳过，
+        // 差分帧依赖之前的关键帧，与其他消息一样不跳过
+        while ((RxFrame = FrameQueue_PeekNewest(&Serial_RxQueue, Bluetooth_IsSnapshot)) != 0)
         {
-            Parse_DualAngle();      // 解析接收到的角度数据
-            Serial_RxFlag = 0;      // 重置接收标志，准备下次接收
+            Bluetooth_Receive(RxFrame->Data, RxFrame->Length, RxFrame->Time);  // 按消息类型分发（含统计请求），消息体直接在队列槽内解析
+            FrameQueue_Pop(&Serial_RxQueue);    // 释放队列槽
         }
+        Bluetooth_Send_Ping();   // 按周期发出时延探测
+        Bluetooth_Send_Credit(); // 向发送端通告已处理的数据包（流控）
+        Bluetooth_Send_Report(); // 按周期向发送端报告链路接收统计（自适应发送速率）
+        Telemetry_Send_Status(); // 按周期发出运行状态遥测
+        Telemetry_DrainLog();    // 从遥测串口发出缓存的日志
+        Monitor_TaskEnd(TASK_PARSE);
 
         // 舵机平滑控制
+        Monitor_TaskBegin(TASK_SERVO);
+        Servo_Playout();        // 回放打开时按时间戳插值出本周期的目标角度
+        Failsafe_Update(&Link_Failsafe, Timer_GetMicros(), (uint32_t)(tune.failTimeout * 1000));  // 链路超时检测
         Servo_SmoothControl();  // 根据目标角度和当前角度，平滑调整舵机位置（8ms/次更新）
+        Monitor_TaskEnd(TASK_SERVO);
 
         // OLED显示控制（16ms刷新一次）
         static uint8_t showCnt = 0;  // 显示计数器
         if(showCnt++ >= 2){
+            Monitor_TaskBegin(TASK_OLED);
             OLED_ShowNum(2,3,(uint16_t)servo1.current,3);  // 显示舵机1当前角度
             OLED_ShowNum(3,3,(uint16_t)servo2.current,3);  // 显示舵机2当前角度
+            OLED_ShowNum(4,3,Link_Quality(&Serial_RxStats),3);  // 显示链路质量
+            OLED_ShowString(4,8,Link_StateText());              // 显示链路状态（OK或失效保护策略）
+            Monitor_TaskEnd(TASK_OLED);
             showCnt = 0;  // 重置计数器
         }
 
+        // 保存舵机状态并喂狗
+        Servo_SaveState();
+        Watchdog_Feed();
+
         // 主循环延时（8ms，与发送端保持同步）
-        Delay_ms(8);
+        Delay_ms(LOOP_INTERVAL);
 		
 	}
 